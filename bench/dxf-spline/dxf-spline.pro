@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Time the import of a drawing of many splines
+# with DxfReader.
+#
+#-------------------------------------------------
+
+QT       -= gui
+
+TARGET = dxf-spline
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+# readers and writers, OpenCASCADE and dxflib
+include($$PWD/../../occQtCore.pri)
@@ -0,0 +1,100 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : main.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Time the import of a drawing of many SPLINE entities.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+
+#include <OSD_Timer.hxx>
+#include <TopoDS.hxx>
+#include <TopExp_Explorer.hxx>
+#include <BRep_Tool.hxx>
+#include <Geom_BSplineCurve.hxx>
+
+#include "dl_dxf.h"
+#include "dxfReader.h"
+
+//! cubic splines of 6 control points on a clamped knot vector.
+static bool writeSplines(const std::string& theFileName, int theNbSplines)
+{
+    static const double THE_KNOTS[] = { 0.0, 0.0, 0.0, 0.0, 1.0, 2.0, 3.0, 3.0, 3.0, 3.0 };
+    const int aNbKnots = sizeof(THE_KNOTS) / sizeof(THE_KNOTS[0]);
+    const int aNbPoles = 6;
+
+    DL_Dxf aDxf;
+    std::unique_ptr<DL_WriterA> aWriter(aDxf.out(theFileName.c_str(), DL_VERSION_2000));
+    if (aWriter.get() == NULL)
+    {
+        return false;
+    }
+
+    DL_WriterA& dw = *aWriter;
+    const DL_Attributes anAttributes("0", 256, -1, "BYLAYER", 1.0);
+
+    dw.sectionEntities();
+    for (int i = 0; i < theNbSplines; i++)
+    {
+        const double x = (i % 1000) * 10.0;
+        const double y = (i / 1000) * 10.0;
+
+        aDxf.writeSpline(dw, DL_SplineData(3, aNbKnots, aNbPoles, 0, 8), anAttributes);
+        for (int k = 0; k < aNbKnots; k++)
+        {
+            aDxf.writeKnot(dw, DL_KnotData(THE_KNOTS[k]));
+        }
+        for (int p = 0; p < aNbPoles; p++)
+        {
+            aDxf.writeControlPoint(dw, DL_ControlPointData(x + p, y + (p % 2) * 2.5, 0.0, 1.0));
+        }
+    }
+    dw.sectionEnd();
+    dw.dxfEOF();
+    dw.close();
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const int aNbSplines = argc > 1 ? atoi(argv[1]) : 100000;
+    const std::string aFileName = "dxf-spline.dxf";
+
+    if (!writeSplines(aFileName, aNbSplines))
+    {
+        fprintf(stderr, "can not write %s\n", aFileName.c_str());
+        return 2;
+    }
+
+    OSD_Timer aTimer;
+    aTimer.Start();
+    DxfReader aReader(aFileName);
+    aTimer.Stop();
+
+    // every spline is one edge on a native b-spline curve.
+    int aNbEdges = 0;
+    int aNbBSplines = 0;
+    for (TopExp_Explorer anExp(aReader.GetShape(), TopAbs_EDGE); anExp.More(); anExp.Next())
+    {
+        Standard_Real aFirst, aLast;
+        const Handle(Geom_Curve) aCurve = BRep_Tool::Curve(TopoDS::Edge(anExp.Current()), aFirst, aLast);
+        if (!Handle(Geom_BSplineCurve)::DownCast(aCurve).IsNull())
+        {
+            ++aNbBSplines;
+        }
+        ++aNbEdges;
+    }
+
+    printf("%d splines read in %.2f s, %d edges, %d on b-spline curves\n", aNbSplines, aTimer.ElapsedTime(), aNbEdges, aNbBSplines);
+
+    remove(aFileName.c_str());
+    return aNbBSplines == aNbSplines ? 0 : 1;
+}
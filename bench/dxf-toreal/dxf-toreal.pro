@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Check and time the real conversion of DL_Dxf,
+# needs neither Qt nor OCCT.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = dxf-toreal
+TEMPLATE = app
+
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+SOURCES += main.cpp
+
+# dxflib
+include($$PWD/../../dxflib/dxflib.pri)
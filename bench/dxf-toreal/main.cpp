@@ -0,0 +1,116 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : main.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Check DL_Dxf::toReal bit for bit against the stream
+*                  conversion it replaced, and time both.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <locale>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dl_dxf.h"
+
+//! the conversion of dxflib before, with the "C" locale it installed while reading.
+static double streamReal(const std::string& theValue)
+{
+    double aReal;
+    std::string aValue = theValue;
+    std::replace(aValue.begin(), aValue.end(), ',', '.');
+    std::istringstream aStream(aValue);
+    aStream.imbue(std::locale::classic());
+    aStream >> aReal;
+    return aReal;
+}
+
+//! values as written by dxflib, other programs and by hand.
+static std::vector<std::string> makeValues(size_t theNbValues)
+{
+    std::mt19937_64 aRandom(1);
+    std::uniform_real_distribution<double> aCoordinate(-1.0e6, 1.0e6);
+    std::uniform_int_distribution<int> anExponent(-300, 300);
+
+    static const char* THE_FORMATS[] = { "%.17g", "%.16f", "%.6f", "%.15g", "%e", "%.3f" };
+    const size_t aNbFormats = sizeof(THE_FORMATS) / sizeof(THE_FORMATS[0]);
+
+    std::vector<std::string> aValues;
+    aValues.reserve(theNbValues);
+    char aText[512];
+    for (size_t i = 0; i < theNbValues; i++)
+    {
+        double aReal = aCoordinate(aRandom);
+        if (i % 10 == 9)
+        {
+            // the whole range, not only drawing coordinates.
+            aReal = aReal * pow(10.0, anExponent(aRandom));
+        }
+        else if (i % 10 == 8)
+        {
+            aReal = floor(aReal);
+        }
+
+        snprintf(aText, sizeof(aText), THE_FORMATS[i % aNbFormats], aReal);
+        std::string aValue = aText;
+
+        // some writers use the decimal comma of their locale.
+        if (i % 7 == 3)
+        {
+            std::replace(aValue.begin(), aValue.end(), '.', ',');
+        }
+        aValues.push_back(aValue);
+    }
+    return aValues;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t aNbValues = argc > 1 ? (size_t)atol(argv[1]) : 4000000;
+    const std::vector<std::string> aValues = makeValues(aNbValues);
+
+    std::vector<double> aStreamReals(aValues.size());
+    std::vector<double> aFastReals(aValues.size());
+
+    std::chrono::steady_clock::time_point aStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < aValues.size(); i++)
+    {
+        aStreamReals[i] = streamReal(aValues[i]);
+    }
+    const double aStreamTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - aStart).count();
+
+    aStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < aValues.size(); i++)
+    {
+        aFastReals[i] = DL_Dxf::toReal(aValues[i].c_str(), aValues[i].length());
+    }
+    const double aFastTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - aStart).count();
+
+    size_t aNbDiffer = 0;
+    for (size_t i = 0; i < aValues.size(); i++)
+    {
+        if (memcmp(&aStreamReals[i], &aFastReals[i], sizeof(double)) != 0)
+        {
+            if (aNbDiffer < 10)
+            {
+                printf("\"%s\": stream %.17g, toReal %.17g\n", aValues[i].c_str(), aStreamReals[i], aFastReals[i]);
+            }
+            ++aNbDiffer;
+        }
+    }
+
+    printf("%zu values, %zu differ, stream %.2f s, toReal %.2f s\n", aValues.size(), aNbDiffer, aStreamTime, aFastTime);
+    return aNbDiffer > 0 ? 1 : 0;
+}
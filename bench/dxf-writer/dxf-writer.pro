@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Time the buffered output of DL_WriterA,
+# needs neither Qt nor OCCT.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = dxf-writer
+TEMPLATE = app
+
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+SOURCES += main.cpp
+
+# dxflib
+include($$PWD/../../dxflib/dxflib.pri)
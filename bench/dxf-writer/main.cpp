@@ -0,0 +1,144 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : main.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Time DL_WriterA with and without the output buffer and
+*                  read the written coordinates back.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dl_dxf.h"
+#include "dl_creationadapter.h"
+
+//! collects the coordinates of the lines read back.
+class lineReader : public DL_CreationAdapter
+{
+public:
+    virtual void addLine(const DL_LineData& theData)
+    {
+        myReals.push_back(theData.x1);
+        myReals.push_back(theData.y1);
+        myReals.push_back(theData.z1);
+        myReals.push_back(theData.x2);
+        myReals.push_back(theData.y2);
+        myReals.push_back(theData.z2);
+    }
+
+    std::vector<double> myReals;
+};
+
+//! write the lines, the time in seconds.
+static double writeLines(const std::string& theFileName, const std::vector<double>& theReals, size_t theBufferSize)
+{
+    const std::chrono::steady_clock::time_point aStart = std::chrono::steady_clock::now();
+
+    DL_Dxf aDxf;
+    std::unique_ptr<DL_WriterA> aWriter(aDxf.out(theFileName.c_str(), DL_VERSION_2000, theBufferSize));
+    if (aWriter.get() == NULL)
+    {
+        return -1.0;
+    }
+
+    DL_WriterA& dw = *aWriter;
+    const DL_Attributes anAttributes("0", 256, -1, "BYLAYER", 1.0);
+
+    dw.sectionEntities();
+    for (size_t i = 0; i + 6 <= theReals.size(); i += 6)
+    {
+        aDxf.writeLine(dw, DL_LineData(theReals[i], theReals[i + 1], theReals[i + 2],
+            theReals[i + 3], theReals[i + 4], theReals[i + 5]), anAttributes);
+    }
+    dw.sectionEnd();
+    dw.dxfEOF();
+    dw.close();
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - aStart).count();
+}
+
+//! number of coordinates read back that differ from the written ones, -1 if unreadable.
+static long compareLines(const std::string& theFileName, const std::vector<double>& theReals)
+{
+    DL_Dxf aDxf;
+    lineReader aReader;
+    if (!aDxf.in(theFileName, &aReader) || aReader.myReals.size() != theReals.size())
+    {
+        return -1;
+    }
+
+    long aNbDiffer = 0;
+    for (size_t i = 0; i < theReals.size(); i++)
+    {
+        if (memcmp(&aReader.myReals[i], &theReals[i], sizeof(double)) != 0)
+        {
+            ++aNbDiffer;
+        }
+    }
+    return aNbDiffer;
+}
+
+static long fileSize(const std::string& theFileName)
+{
+    FILE* aFile = fopen(theFileName.c_str(), "rb");
+    if (aFile == NULL)
+    {
+        return -1;
+    }
+    fseek(aFile, 0, SEEK_END);
+    const long aSize = ftell(aFile);
+    fclose(aFile);
+    return aSize;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t aNbLines = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    const size_t aBufferSize = 1 << 20;
+
+    // drawing coordinates with all digits, and some round ones.
+    std::mt19937_64 aRandom(1);
+    std::uniform_real_distribution<double> aCoordinate(-1.0e4, 1.0e4);
+    std::vector<double> aReals(6 * aNbLines);
+    for (size_t i = 0; i < aReals.size(); i++)
+    {
+        aReals[i] = i % 5 == 4 ? (double)(i % 1000) * 0.25 : aCoordinate(aRandom);
+    }
+
+    const std::string aPlainName = "dxf-writer-plain.dxf";
+    const std::string aBufferedName = "dxf-writer-buffered.dxf";
+
+    const double aPlainTime = writeLines(aPlainName, aReals, 0);
+    const double aBufferedTime = writeLines(aBufferedName, aReals, aBufferSize);
+    if (aPlainTime < 0.0 || aBufferedTime < 0.0)
+    {
+        fprintf(stderr, "can not write the files\n");
+        return 2;
+    }
+
+    const long aPlainDiffer = compareLines(aPlainName, aReals);
+    const long aBufferedDiffer = compareLines(aBufferedName, aReals);
+
+    printf("%zu lines\n", aNbLines);
+    printf("unbuffered  %.2f s  %ld bytes  %ld of %zu coordinates differ\n",
+        aPlainTime, fileSize(aPlainName), aPlainDiffer, aReals.size());
+    printf("buffered    %.2f s  %ld bytes  %ld of %zu coordinates differ\n",
+        aBufferedTime, fileSize(aBufferedName), aBufferedDiffer, aReals.size());
+
+    remove(aPlainName.c_str());
+    remove(aBufferedName.c_str());
+
+    // only the buffered output promises exact coordinates.
+    return aBufferedDiffer == 0 ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : main.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Convert CAD files in batch without a display.
+*/
+
+#include <stdio.h>
+#include <math.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <OSD_Timer.hxx>
+#include <OSD_MemInfo.hxx>
+#include <Message.hxx>
+#include <Message_Messenger.hxx>
+#include <Message_Printer.hxx>
+#include <Message_SequenceOfPrinters.hxx>
+
+#include <occLoader.h>
+#include <occWriter.h>
+
+//! one file to convert.
+struct occConvertJob
+{
+    QString Input;
+    QString Output;
+};
+
+//! peak memory of the process in MB.
+static double peakMemory(void)
+{
+    OSD_MemInfo aMemInfo;
+    return aMemInfo.Value(OSD_MemInfo::MemWorkingSetPeak) / (1024.0 * 1024.0);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("occqt-convert");
+
+    QCommandLineParser aParser;
+    aParser.setApplicationDescription("Convert brep, iges, step, stl and dxf files to brep, iges, step, stl or dxf.");
+    aParser.addHelpOption();
+    aParser.addPositionalArgument("input", "Input file, or all input files with --to.");
+    aParser.addPositionalArgument("output", "Output file, the format is chosen by the suffix.");
+
+    QCommandLineOption aThreadsOption("threads", "Number of files converted at the same time, default one per core.", "N");
+    QCommandLineOption aListOption("list", "Text file with one input file per line.", "file");
+    QCommandLineOption aToOption("to", "Output format of all input files: brep, iges, step, stl or dxf.", "format");
+    QCommandLineOption anOutDirOption("output-dir", "Directory of the output files, default the directory of the input.", "dir");
+    QCommandLineOption aDeflectionOption("deflection", "Linear deflection of stl files, 0 for automatic.", "value", "0");
+    QCommandLineOption anAngleOption("angle", "Angular deflection of stl files in degree.", "degree", "20");
+    QCommandLineOption aTileOption("dxf-tile-size", "Split dxf layers into square tiles of this size, 0 for no tiles.", "size", "0");
+    QCommandLineOption aToleranceOption("dxf-tolerance", "Chain loose dxf edges with ends closer than this into wires, 0 for not chained.", "value", "1e-6");
+    QCommandLineOption aCacheOption("cache", "Use the import cache of translated iges and step files.");
+    QCommandLineOption aVerboseOption("verbose", "Print the messages of the readers and writers.");
+    aParser.addOption(aThreadsOption);
+    aParser.addOption(aListOption);
+    aParser.addOption(aToOption);
+    aParser.addOption(anOutDirOption);
+    aParser.addOption(aDeflectionOption);
+    aParser.addOption(anAngleOption);
+    aParser.addOption(aTileOption);
+    aParser.addOption(aToleranceOption);
+    aParser.addOption(aCacheOption);
+    aParser.addOption(aVerboseOption);
+    aParser.process(a);
+
+    QStringList anInputs = aParser.positionalArguments();
+
+    // collect the jobs.
+    std::vector<occConvertJob> aJobs;
+    if (aParser.isSet(aToOption) || aParser.isSet(aListOption))
+    {
+        const QString aFormat = aParser.value(aToOption).toLower();
+        if (!occWriter::isSupported("." + aFormat))
+        {
+            fprintf(stderr, "unknown output format \"%s\"\n", aFormat.toLocal8Bit().constData());
+            return 2;
+        }
+
+        if (aParser.isSet(aListOption))
+        {
+            QFile aList(aParser.value(aListOption));
+            if (!aList.open(QIODevice::ReadOnly | QIODevice::Text))
+            {
+                fprintf(stderr, "can not read %s\n", aList.fileName().toLocal8Bit().constData());
+                return 2;
+            }
+
+            QTextStream aStream(&aList);
+            while (!aStream.atEnd())
+            {
+                const QString aLine = aStream.readLine().trimmed();
+                if (!aLine.isEmpty() && !aLine.startsWith('#'))
+                    anInputs.append(aLine);
+            }
+        }
+
+        const QString anOutDir = aParser.value(anOutDirOption);
+        for (int i = 0; i < anInputs.size(); i++)
+        {
+            QFileInfo Info(anInputs[i]);
+            const QString aDir = anOutDir.isEmpty() ? Info.path() : anOutDir;
+
+            occConvertJob aJob;
+            aJob.Input = anInputs[i];
+            aJob.Output = QDir(aDir).filePath(Info.completeBaseName() + "." + aFormat);
+            aJobs.push_back(aJob);
+        }
+    }
+    else if (anInputs.size() == 2)
+    {
+        occConvertJob aJob;
+        aJob.Input = anInputs[0];
+        aJob.Output = anInputs[1];
+        aJobs.push_back(aJob);
+
+        if (!occWriter::isSupported(aJob.Output))
+        {
+            fprintf(stderr, "unknown output format of %s\n", aJob.Output.toLocal8Bit().constData());
+            return 2;
+        }
+    }
+
+    if (aJobs.empty())
+    {
+        aParser.showHelp(2);
+    }
+
+    // files are converted in parallel, the cores left are given to the
+    // transfer of step roots. step and iges files are still read one at a
+    // time where the OCCT translators use global state, see StepReader.
+    int aNbThreads = aParser.isSet(aThreadsOption) ? aParser.value(aThreadsOption).toInt() : QThread::idealThreadCount();
+    aNbThreads = qBound(1, aNbThreads, (int)aJobs.size());
+
+    occLoadOptions aLoadOptions;
+    aLoadOptions.NbThreads = qMax(1, QThread::idealThreadCount() / aNbThreads);
+    aLoadOptions.DxfTileSize = aParser.value(aTileOption).toDouble();
+    aLoadOptions.DxfTolerance = aParser.value(aToleranceOption).toDouble();
+    QThreadPool::globalInstance()->setMaxThreadCount(aNbThreads);
+
+    if (!aParser.isSet(aVerboseOption))
+    {
+        const Message_SequenceOfPrinters& aPrinters = Message::DefaultMessenger()->Printers();
+        for (int i = 1; i <= aPrinters.Length(); i++)
+        {
+            aPrinters.Value(i)->SetTraceLevel(Message_Warning);
+        }
+    }
+
+    occWriteOptions anOptions;
+    anOptions.StlDeflection = aParser.value(aDeflectionOption).toDouble();
+    anOptions.StlAngle = aParser.value(anAngleOption).toDouble() * M_PI / 180.0;
+
+    occShapeCache aCache;
+    aCache.setEnabled(aParser.isSet(aCacheOption));
+
+    std::mutex aMutex;
+    std::atomic<int> aNbDone(0);
+    std::atomic<int> aNbFailed(0);
+    const int aNbJobs = (int)aJobs.size();
+
+    OSD_Timer aTimer;
+    aTimer.Start();
+
+    QtConcurrent::blockingMap(aJobs, [&](const occConvertJob& theJob)
+    {
+        OSD_Timer aReadTimer;
+        aReadTimer.Start();
+        occLoadResult aResult = occLoader::read(theJob.Input, NULL, &aCache, aLoadOptions);
+        aReadTimer.Stop();
+
+        bool isDone = aResult.IsDone && !aResult.Shape.IsNull();
+        const char* anError = isDone ? "" : "can not read";
+
+        occWriter aWriter(anOptions);
+        if (isDone)
+        {
+            Handle(TopTools_HSequenceOfShape) aSequence = new TopTools_HSequenceOfShape();
+            aSequence->Append(aResult.Shape);
+
+            isDone = aWriter.write(theJob.Output, aSequence);
+            anError = isDone ? "" : "can not write";
+        }
+
+        if (!isDone)
+            ++aNbFailed;
+
+        // the peak is of the whole process, all running conversions together.
+        const double aPeak = peakMemory();
+
+        std::lock_guard<std::mutex> aLock(aMutex);
+        const int anIndex = ++aNbDone;
+        if (isDone)
+        {
+            printf("[%d/%d] %s -> %s  read %.2f s%s  write %.2f s  peak %.0f MB\n", anIndex, aNbJobs,
+                theJob.Input.toLocal8Bit().constData(), theJob.Output.toLocal8Bit().constData(),
+                aReadTimer.ElapsedTime(), aResult.IsCached ? " (cached)" : "",
+                aWriter.meshTime() + aWriter.writeTime(), aPeak);
+        }
+        else
+        {
+            printf("[%d/%d] %s -> %s  FAILED: %s  peak %.0f MB\n", anIndex, aNbJobs,
+                theJob.Input.toLocal8Bit().constData(), theJob.Output.toLocal8Bit().constData(), anError, aPeak);
+        }
+        fflush(stdout);
+    });
+
+    aTimer.Stop();
+
+    printf("%d files, %d failed, %.2f s on %d threads, peak %.0f MB\n", aNbJobs, (int)aNbFailed,
+        aTimer.ElapsedTime(), aNbThreads, peakMemory());
+
+    return aNbFailed > 0 ? 1 : 0;
+}
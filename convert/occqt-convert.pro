@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Batch converter of CAD files, no display needed.
+#
+#-------------------------------------------------
+
+QT       += core concurrent
+QT       -= gui
+
+TARGET = occqt-convert
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+# readers and writers, OpenCASCADE and dxflib
+include($$PWD\..\occQtCore.pri)
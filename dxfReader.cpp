@@ -2,6 +2,24 @@
 
 #include <gp_Circ.hxx>
 #include <gp_Elips.hxx>
+#include <gp_Ax2.hxx>
+#include <gp_GTrsf.hxx>
+
+#include <deque>
+#include <unordered_map>
+
+#include <Precision.hxx>
+
+#include <Geom_Line.hxx>
+#include <Geom_Circle.hxx>
+#include <GeomAPI_Interpolate.hxx>
+
+#include <TColgp_Array1OfPnt.hxx>
+#include <TColgp_HArray1OfPnt.hxx>
+#include <TColStd_Array1OfReal.hxx>
+#include <TColStd_Array1OfInteger.hxx>
+
+#include <Standard_Failure.hxx>
 
 #include <GC_MakeSegment.hxx>
 #include <GC_MakeCircle.hxx>
@@ -9,18 +27,139 @@
 #include <GC_MakeEllipse.hxx>
 
 #include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <TopLoc_Location.hxx>
 #include <TopoDS_Edge.hxx>
+#include <TopoDS_Wire.hxx>
+#include <TopExp.hxx>
+
+#include <BRep_Tool.hxx>
 
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <BRepBuilderAPI_MakeEdge.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <BRepBuilderAPI_MakePolygon.hxx>
+#include <BRepBuilderAPI_GTransform.hxx>
+#include <BRepBuilderAPI_Transform.hxx>
 
-DxfReader::DxfReader(const std::string& fileName) : m_Dxf(new DL_Dxf())
+/**
+* @brief Uniform grid of points, cells as large as the tolerance, so that
+* a point only needs to be compared with the points of the 27 cells around it.
+*/
+class VertexGrid
 {
-    m_Builder.MakeCompound(m_Shape);
+public:
+    VertexGrid(double theTolerance) : m_Tolerance(theTolerance)
+    {
+    }
+
+    /**
+    * @brief Get the index of a point within the tolerance, adding the point if there is none.
+    */
+    int Find(const gp_Pnt& thePoint)
+    {
+        const long long ix = (long long)floor(thePoint.X() / m_Tolerance);
+        const long long iy = (long long)floor(thePoint.Y() / m_Tolerance);
+        const long long iz = (long long)floor(thePoint.Z() / m_Tolerance);
+
+        const double aSquareTol = m_Tolerance * m_Tolerance;
+
+        for (long long dx = -1; dx <= 1; ++dx)
+        {
+            for (long long dy = -1; dy <= 1; ++dy)
+            {
+                for (long long dz = -1; dz <= 1; ++dz)
+                {
+                    std::unordered_map<Cell, std::vector<int>, CellHash>::const_iterator it =
+                        m_Cells.find(Cell(ix + dx, iy + dy, iz + dz));
+                    if (it == m_Cells.end())
+                    {
+                        continue;
+                    }
+
+                    for (size_t i = 0; i < it->second.size(); ++i)
+                    {
+                        if (m_Points[it->second[i]].SquareDistance(thePoint) <= aSquareTol)
+                        {
+                            return it->second[i];
+                        }
+                    }
+                }
+            }
+        }
+
+        m_Points.push_back(thePoint);
+        m_Cells[Cell(ix, iy, iz)].push_back((int)m_Points.size() - 1);
+
+        return (int)m_Points.size() - 1;
+    }
+
+    int Size(void) const
+    {
+        return (int)m_Points.size();
+    }
+
+    const gp_Pnt& Point(int theIndex) const
+    {
+        return m_Points[theIndex];
+    }
+
+private:
+    struct Cell
+    {
+        Cell(long long x, long long y, long long z) : X(x), Y(y), Z(z) {}
+
+        bool operator==(const Cell& theOther) const
+        {
+            return X == theOther.X && Y == theOther.Y && Z == theOther.Z;
+        }
+
+        long long X;
+        long long Y;
+        long long Z;
+    };
+
+    struct CellHash
+    {
+        size_t operator()(const Cell& theCell) const
+        {
+            return (size_t)(theCell.X * 73856093LL ^ theCell.Y * 19349663LL ^ theCell.Z * 83492791LL);
+        }
+    };
+
+private:
+    double m_Tolerance;
+
+    std::vector<gp_Pnt> m_Points;
+
+    std::unordered_map<Cell, std::vector<int>, CellHash> m_Cells;
+};
+
+DxfReader::DxfReader(const std::string& fileName, double tileSize) : m_Dxf(new DL_Dxf()),
+    m_TileSize(tileSize),
+    m_LastPart(-1),
+    m_InPolyline(false),
+    m_PolylineFlags(0),
+    m_PolylineElevation(0.0),
+    m_InSpline(false),
+    m_SplineDegree(0),
+    m_SplineRational(false),
+    m_CurrentBlock(NULL)
+{
+    // Large drawings are read through a memory mapping with the ENTITIES
+    // section parsed on all cores, fall back to the stdio reader if the
+    // file can not be mapped.
+    if (!m_Dxf->inParallel(fileName, this))
+    {
+        m_Dxf->in(fileName, this);
+    }
+    endPolyline();
 
-    m_Dxf->in(fileName, this);  
+    m_Builder.MakeCompound(m_Shape);
+    for (size_t i = 0; i < m_Parts.size(); ++i)
+    {
+        m_Builder.Add(m_Shape, m_Parts[i].Shape);
+    }
 }
 
 DxfReader::~DxfReader(void)
@@ -32,16 +171,258 @@ const TopoDS_Shape& DxfReader::GetShape() const
     return m_Shape;
 }
 
+int DxfReader::NbParts(void) const
+{
+    return (int)m_Parts.size();
+}
+
+const TopoDS_Shape& DxfReader::GetPart(int theIndex) const
+{
+    return m_Parts[theIndex].Shape;
+}
+
+const std::string& DxfReader::GetPartLayer(int theIndex) const
+{
+    return m_Parts[theIndex].Layer;
+}
+
+void DxfReader::ConnectEdges(double theTolerance, bool theMakeFaces)
+{
+    if (theTolerance <= 0.0)
+    {
+        theTolerance = Precision::Confusion();
+    }
+
+    m_Builder.MakeCompound(m_Shape);
+    for (size_t i = 0; i < m_Parts.size(); ++i)
+    {
+        m_Parts[i].Shape = connectEdges(m_Parts[i].Shape, theTolerance, theMakeFaces);
+        m_Builder.Add(m_Shape, m_Parts[i].Shape);
+    }
+}
+
+TopoDS_Compound DxfReader::connectEdges(const TopoDS_Compound& thePart, double theTolerance, bool theMakeFaces)
+{
+    TopoDS_Compound aResult;
+    m_Builder.MakeCompound(aResult);
+
+    // loose edges, wires of polylines, faces and block instances stay as they are.
+    std::vector<TopoDS_Edge> anEdges;
+    for (TopoDS_Iterator it(thePart); it.More(); it.Next())
+    {
+        TopoDS_Vertex aFirst;
+        TopoDS_Vertex aLast;
+        if (it.Value().ShapeType() == TopAbs_EDGE)
+        {
+            TopExp::Vertices(TopoDS::Edge(it.Value()), aFirst, aLast);
+        }
+
+        if (aFirst.IsNull() || aLast.IsNull())
+        {
+            m_Builder.Add(aResult, it.Value());
+            continue;
+        }
+
+        anEdges.push_back(TopoDS::Edge(it.Value()));
+    }
+
+    const int aNbEdges = (int)anEdges.size();
+    if (aNbEdges == 0)
+    {
+        return aResult;
+    }
+
+    // nodes of the edge ends, 2 * i for the first and 2 * i + 1 for the last vertex.
+    VertexGrid aGrid(theTolerance);
+    std::vector<int> aNodes(2 * aNbEdges);
+    std::vector<TopoDS_Vertex> anOldVertices(2 * aNbEdges);
+    for (int i = 0; i < aNbEdges; ++i)
+    {
+        TopExp::Vertices(anEdges[i], anOldVertices[2 * i], anOldVertices[2 * i + 1]);
+        aNodes[2 * i] = aGrid.Find(BRep_Tool::Pnt(anOldVertices[2 * i]));
+        aNodes[2 * i + 1] = aGrid.Find(BRep_Tool::Pnt(anOldVertices[2 * i + 1]));
+    }
+
+    const int aNbNodes = aGrid.Size();
+    std::vector<TopoDS_Vertex> aVertices(aNbNodes);
+    for (int n = 0; n < aNbNodes; ++n)
+    {
+        m_Builder.MakeVertex(aVertices[n], aGrid.Point(n), theTolerance);
+    }
+
+    // the same geometry on the shared vertices.
+    for (int i = 0; i < aNbEdges; ++i)
+    {
+        Standard_Real aFirst = 0.0;
+        Standard_Real aLast = 0.0;
+        BRep_Tool::Range(anEdges[i], aFirst, aLast);
+
+        TopoDS_Edge anEdge = TopoDS::Edge(anEdges[i].Oriented(TopAbs_FORWARD).EmptyCopied());
+
+        for (int k = 0; k < 2; ++k)
+        {
+            const TopoDS_Vertex& anOld = anOldVertices[2 * i + k];
+            const TopoDS_Vertex& aNew = aVertices[aNodes[2 * i + k]];
+            const Standard_Real aTol = BRep_Tool::Pnt(anOld).Distance(aGrid.Point(aNodes[2 * i + k])) + BRep_Tool::Tolerance(anOld);
+
+            m_Builder.Add(anEdge, aNew.Oriented(k == 0 ? TopAbs_FORWARD : TopAbs_REVERSED));
+            m_Builder.UpdateVertex(aNew, k == 0 ? aFirst : aLast, anEdge, aTol);
+        }
+
+        anEdges[i] = anEdge;
+    }
+
+    // edges around each node, walked with a cursor so every entry is visited once.
+    std::vector<int> anOffsets(aNbNodes + 1, 0);
+    for (int i = 0; i < 2 * aNbEdges; ++i)
+    {
+        ++anOffsets[aNodes[i] + 1];
+    }
+    for (int n = 0; n < aNbNodes; ++n)
+    {
+        anOffsets[n + 1] += anOffsets[n];
+    }
+
+    std::vector<int> anIncident(2 * aNbEdges);
+    std::vector<int> aCursors(anOffsets.begin(), anOffsets.end() - 1);
+    for (int i = 0; i < 2 * aNbEdges; ++i)
+    {
+        anIncident[aCursors[aNodes[i]]++] = i / 2;
+    }
+    aCursors.assign(anOffsets.begin(), anOffsets.end() - 1);
+
+    std::vector<bool> isUsed(aNbEdges, false);
+
+    for (int i = 0; i < aNbEdges; ++i)
+    {
+        if (isUsed[i])
+        {
+            continue;
+        }
+        isUsed[i] = true;
+
+        // edge index and whether it runs forward in the chain.
+        std::deque<std::pair<int, bool> > aChain;
+        aChain.push_back(std::make_pair(i, true));
+
+        int aStart = aNodes[2 * i];
+        int anEnd = aNodes[2 * i + 1];
+
+        // grow the chain at its end, then at its start.
+        for (int aSide = 0; aSide < 2 && aStart != anEnd; ++aSide)
+        {
+            int& aNode = aSide == 0 ? anEnd : aStart;
+            while (aStart != anEnd)
+            {
+                int& aCursor = aCursors[aNode];
+                while (aCursor < anOffsets[aNode + 1] && isUsed[anIncident[aCursor]])
+                {
+                    ++aCursor;
+                }
+                if (aCursor == anOffsets[aNode + 1])
+                {
+                    break;
+                }
+
+                const int e = anIncident[aCursor];
+                isUsed[e] = true;
+
+                // at the end the edge has to start at the node, at the start end there.
+                const bool isForward = (aNodes[2 * e] == aNode) == (aSide == 0);
+                aNode = isForward == (aSide == 0) ? aNodes[2 * e + 1] : aNodes[2 * e];
+
+                if (aSide == 0)
+                {
+                    aChain.push_back(std::make_pair(e, isForward));
+                }
+                else
+                {
+                    aChain.push_front(std::make_pair(e, isForward));
+                }
+            }
+        }
+
+        if (aChain.size() == 1 && aStart != anEnd)
+        {
+            m_Builder.Add(aResult, anEdges[i]);
+            continue;
+        }
+
+        TopoDS_Wire aWire;
+        m_Builder.MakeWire(aWire);
+        for (size_t k = 0; k < aChain.size(); ++k)
+        {
+            const TopoDS_Edge& anEdge = anEdges[aChain[k].first];
+            m_Builder.Add(aWire, aChain[k].second ? anEdge : TopoDS::Edge(anEdge.Reversed()));
+        }
+        aWire.Closed(aStart == anEnd);
+
+        if (theMakeFaces && aWire.Closed())
+        {
+            BRepBuilderAPI_MakeFace aMakeFace(aWire, Standard_True);
+            if (aMakeFace.IsDone())
+            {
+                m_Builder.Add(aResult, aMakeFace.Face());
+                continue;
+            }
+        }
+
+        m_Builder.Add(aResult, aWire);
+    }
+
+    return aResult;
+}
+
+void DxfReader::addShape(const TopoDS_Shape& theShape, double x, double y)
+{
+    addShape(theShape, attributes.getLayer(), x, y);
+}
+
+void DxfReader::addShape(const TopoDS_Shape& theShape, const std::string& theLayer, double x, double y)
+{
+    if (m_CurrentBlock != NULL)
+    {
+        m_Builder.Add(m_CurrentBlock->Shape, theShape);
+        return;
+    }
+
+    PartKey aKey(theLayer, std::make_pair(0, 0));
+    if (m_TileSize > 0.0)
+    {
+        aKey.second.first = (int)floor(x / m_TileSize);
+        aKey.second.second = (int)floor(y / m_TileSize);
+    }
+
+    if (m_LastPart < 0 || aKey != m_LastKey)
+    {
+        std::map<PartKey, int>::const_iterator it = m_PartIndex.find(aKey);
+        if (it == m_PartIndex.end())
+        {
+            Part aPart;
+            aPart.Layer = aKey.first;
+            m_Builder.MakeCompound(aPart.Shape);
+            m_Parts.push_back(aPart);
+
+            it = m_PartIndex.insert(std::make_pair(aKey, (int)m_Parts.size() - 1)).first;
+        }
+
+        m_LastKey = aKey;
+        m_LastPart = it->second;
+    }
+
+    m_Builder.Add(m_Parts[m_LastPart].Shape, theShape);
+}
+
 void DxfReader::addPoint(const DL_PointData& point)
 {
-    m_Builder.Add(m_Shape, BRepBuilderAPI_MakeVertex(gp_Pnt(point.x, point.y, point.z)));
+    addShape(BRepBuilderAPI_MakeVertex(gp_Pnt(point.x, point.y, point.z)), point.x, point.y);
 }
 
 void DxfReader::addLine(const DL_LineData& line)
 {
     Handle_Geom_Curve theSegment = GC_MakeSegment(gp_Pnt(line.x1, line.y1, line.z1), gp_Pnt(line.x2, line.y2, line.z2)).Value();
 
-    m_Builder.Add(m_Shape, BRepBuilderAPI_MakeEdge(theSegment));
+    addShape(BRepBuilderAPI_MakeEdge(theSegment), line.x1, line.y1);
 }
 
 void DxfReader::addArc(const DL_ArcData &arc)
@@ -52,7 +433,7 @@ void DxfReader::addArc(const DL_ArcData &arc)
 
     Handle_Geom_Curve theArc = GC_MakeArcOfCircle(theCircle, (arc.angle1 * M_PI / 180), (arc.angle2 * M_PI / 180), false).Value();
 
-    m_Builder.Add(m_Shape, BRepBuilderAPI_MakeEdge(theArc));
+    addShape(BRepBuilderAPI_MakeEdge(theArc), arc.cx, arc.cy);
 }
 
 void DxfReader::addCircle(const DL_CircleData& circle)
@@ -63,7 +444,7 @@ void DxfReader::addCircle(const DL_CircleData& circle)
 
     Handle_Geom_Curve theCircle = GC_MakeCircle(aCircle).Value();
 
-    m_Builder.Add(m_Shape, BRepBuilderAPI_MakeEdge(theCircle));
+    addShape(BRepBuilderAPI_MakeEdge(theCircle), circle.cx, circle.cy);
 }
 
 void DxfReader::addEllipse(const DL_EllipseData& ellipse)
@@ -72,23 +453,317 @@ void DxfReader::addEllipse(const DL_EllipseData& ellipse)
 
 void DxfReader::addPolyline(const DL_PolylineData& polyline)
 {
+    // polyline without vertices or end of entity.
+    endPolyline();
+
+    m_InPolyline = true;
+    m_PolylineFlags = polyline.flags;
+    m_PolylineElevation = polyline.elevation;
+    m_PolylineLayer = attributes.getLayer();
+
+    m_PolylineVertices.clear();
+    m_PolylineVertices.reserve(4 * polyline.number);
 }
 
 void DxfReader::addVertex(const DL_VertexData& vertex)
 {
-    m_Builder.Add(m_Shape, BRepBuilderAPI_MakeVertex(gp_Pnt(vertex.x, vertex.y, vertex.z)));
+    if (!m_InPolyline)
+    {
+        addShape(BRepBuilderAPI_MakeVertex(gp_Pnt(vertex.x, vertex.y, vertex.z)), vertex.x, vertex.y);
+        return;
+    }
+
+    m_PolylineVertices.push_back(vertex.x);
+    m_PolylineVertices.push_back(vertex.y);
+    m_PolylineVertices.push_back(vertex.z);
+    m_PolylineVertices.push_back(vertex.bulge);
+}
+
+void DxfReader::endEntity()
+{
+    endPolyline();
+    endSpline();
+}
+
+void DxfReader::endPolyline(void)
+{
+    if (!m_InPolyline)
+    {
+        return;
+    }
+    m_InPolyline = false;
+
+    // polygon and polyface meshes are not supported.
+    if (m_PolylineFlags & (16 | 64))
+    {
+        return;
+    }
+
+    const size_t aNbVertices = m_PolylineVertices.size() / 4;
+    if (aNbVertices < 2)
+    {
+        return;
+    }
+
+    const bool isClosed = (m_PolylineFlags & 1) != 0;
+    const bool is3d = (m_PolylineFlags & 8) != 0;
+    const Standard_Real aTol = Precision::Confusion();
+    const double* v = &m_PolylineVertices[0];
+
+    // 2d polylines lie in the plane of their elevation (old style
+    // polylines keep it in the vertices).
+    const double anElevation = m_PolylineElevation != 0.0 ? m_PolylineElevation : v[2];
+
+    gp_Pnt aFirstPnt(v[0], v[1], is3d ? v[2] : anElevation);
+    TopoDS_Vertex aFirstVertex;
+    m_Builder.MakeVertex(aFirstVertex, aFirstPnt, aTol);
+
+    TopoDS_Wire aWire;
+    m_Builder.MakeWire(aWire);
+
+    gp_Pnt aPrevPnt = aFirstPnt;
+    TopoDS_Vertex aPrevVertex = aFirstVertex;
+    double aPrevBulge = is3d ? 0.0 : v[3];
+    bool isEmpty = true;
+
+    const size_t aNbSegments = isClosed ? aNbVertices : aNbVertices - 1;
+    for (size_t i = 1; i <= aNbSegments; ++i)
+    {
+        const bool isClosing = (i == aNbVertices);
+        const double* p = &v[4 * (isClosing ? 0 : i)];
+        const double aBulge = (is3d || isClosing) ? 0.0 : p[3];
+
+        gp_Pnt aPnt(p[0], p[1], is3d ? p[2] : anElevation);
+
+        // duplicate vertex, its bulge applies to the next segment.
+        if (aPnt.Distance(aPrevPnt) <= aTol)
+        {
+            aPrevBulge = aBulge;
+            continue;
+        }
+
+        // the last vertex closes the wire if it is on the first.
+        TopoDS_Vertex aVertex;
+        if (i >= aNbVertices - 1 && aPnt.Distance(aFirstPnt) <= aTol)
+        {
+            aVertex = aFirstVertex;
+        }
+        else
+        {
+            m_Builder.MakeVertex(aVertex, aPnt, aTol);
+        }
+
+        m_Builder.Add(aWire, makeSegment(aPrevPnt, aPnt, aPrevVertex, aVertex, aPrevBulge));
+        isEmpty = false;
+
+        aPrevPnt = aPnt;
+        aPrevVertex = aVertex;
+        aPrevBulge = aBulge;
+    }
+
+    if (isEmpty)
+    {
+        return;
+    }
+
+    aWire.Closed(aPrevVertex.IsSame(aFirstVertex));
+
+    addShape(aWire, m_PolylineLayer, v[0], v[1]);
+}
+
+TopoDS_Edge DxfReader::makeSegment(const gp_Pnt& theStart, const gp_Pnt& theEnd,
+    const TopoDS_Vertex& theStartVertex, const TopoDS_Vertex& theEndVertex, double theBulge)
+{
+    const Standard_Real aTol = Precision::Confusion();
+
+    Handle(Geom_Curve) aCurve;
+    Standard_Real aLast = 0.0;
+
+    if (Abs(theBulge) < Precision::Angular())
+    {
+        gp_Vec aChord(theStart, theEnd);
+        aLast = aChord.Magnitude();
+        aCurve = new Geom_Line(theStart, gp_Dir(aChord));
+    }
+    else
+    {
+        // bulge = tan(angle / 4), positive for counter clockwise arcs.
+        const double dx = theEnd.X() - theStart.X();
+        const double dy = theEnd.Y() - theStart.Y();
+        const double aChord = sqrt(dx * dx + dy * dy);
+        const double aHalf = 0.5 * aChord;
+        const double aSagitta = theBulge * aHalf;
+        const double aRadius = (aHalf * aHalf + aSagitta * aSagitta) / (2.0 * aSagitta);
+
+        // center on the left of the chord for counter clockwise arcs below 180 degree.
+        const double anOffset = aRadius - aSagitta;
+        const double aCenterX = 0.5 * (theStart.X() + theEnd.X()) - dy / aChord * anOffset;
+        const double aCenterY = 0.5 * (theStart.Y() + theEnd.Y()) + dx / aChord * anOffset;
+
+        gp_Pnt aCenter(aCenterX, aCenterY, theStart.Z());
+        gp_Ax2 anAxis(aCenter, theBulge > 0.0 ? gp::DZ() : -gp::DZ(), gp_Dir(gp_Vec(aCenter, theStart)));
+
+        aLast = 4.0 * atan(Abs(theBulge));
+        aCurve = new Geom_Circle(anAxis, Abs(aRadius));
+    }
+
+    TopoDS_Edge anEdge;
+    m_Builder.MakeEdge(anEdge, aCurve, aTol);
+    m_Builder.Add(anEdge, theStartVertex.Oriented(TopAbs_FORWARD));
+    m_Builder.Add(anEdge, theEndVertex.Oriented(TopAbs_REVERSED));
+    m_Builder.Range(anEdge, 0.0, aLast);
+    m_Builder.UpdateVertex(theStartVertex, 0.0, anEdge, aTol);
+    m_Builder.UpdateVertex(theEndVertex, aLast, anEdge, aTol);
+
+    return anEdge;
 }
 
 void DxfReader::addSpline(const DL_SplineData& spline)
 {
+    m_InSpline = true;
+    m_SplineDegree = spline.degree;
+    m_SplineRational = false;
+
+    // buffers keep their capacity from spline to spline.
+    m_SplinePoles.clear();
+    m_SplinePoles.reserve(spline.nControl);
+    m_SplineWeights.clear();
+    m_SplineWeights.reserve(spline.nControl);
+    m_SplineKnots.clear();
+    m_SplineKnots.reserve(spline.nKnots);
+    m_SplineFitPoints.clear();
+    m_SplineFitPoints.reserve(spline.nFit);
+
+    m_SplineStartTangent.SetCoord(spline.tangentStartX, spline.tangentStartY, spline.tangentStartZ);
+    m_SplineEndTangent.SetCoord(spline.tangentEndX, spline.tangentEndY, spline.tangentEndZ);
 }
 
 void DxfReader::addKnot(const DL_KnotData& knot)
 {
+    m_SplineKnots.push_back(knot.k);
 }
 
 void DxfReader::addControlPoint(const DL_ControlPointData& cp)
 {
+    m_SplinePoles.push_back(gp_Pnt(cp.x, cp.y, cp.z));
+    m_SplineWeights.push_back(cp.w);
+
+    if (cp.w != 1.0)
+    {
+        m_SplineRational = true;
+    }
+}
+
+void DxfReader::addFitPoint(const DL_FitPointData& fp)
+{
+    m_SplineFitPoints.push_back(gp_Pnt(fp.x, fp.y, fp.z));
+}
+
+void DxfReader::endSpline(void)
+{
+    if (!m_InSpline)
+    {
+        return;
+    }
+    m_InSpline = false;
+
+    Handle(Geom_BSplineCurve) aCurve;
+
+    try
+    {
+        if (!m_SplinePoles.empty())
+        {
+            aCurve = makeBSpline();
+        }
+        else if (m_SplineFitPoints.size() >= 2)
+        {
+            aCurve = interpolateBSpline();
+        }
+    }
+    catch (Standard_Failure&)
+    {
+        // invalid knots or poles, the spline is skipped.
+        aCurve.Nullify();
+    }
+
+    if (aCurve.IsNull())
+    {
+        return;
+    }
+
+    const gp_Pnt& aStart = aCurve->StartPoint();
+    addShape(BRepBuilderAPI_MakeEdge(aCurve), aStart.X(), aStart.Y());
+}
+
+Handle(Geom_BSplineCurve) DxfReader::makeBSpline(void)
+{
+    const int aNbPoles = (int)m_SplinePoles.size();
+    const int aNbFlatKnots = (int)m_SplineKnots.size();
+
+    if (m_SplineDegree < 1 || aNbPoles < 2 || aNbFlatKnots != aNbPoles + m_SplineDegree + 1)
+    {
+        return Handle(Geom_BSplineCurve)();
+    }
+
+    // distinct knots and their multiplicities in one pass over the flat knots.
+    m_SplineDistinctKnots.clear();
+    m_SplineMults.clear();
+    for (int i = 0; i < aNbFlatKnots; ++i)
+    {
+        const double aKnot = m_SplineKnots[i];
+        if (!m_SplineDistinctKnots.empty() &&
+            aKnot - m_SplineDistinctKnots.back() <= Epsilon(Abs(m_SplineDistinctKnots.back())))
+        {
+            ++m_SplineMults.back();
+        }
+        else
+        {
+            m_SplineDistinctKnots.push_back(aKnot);
+            m_SplineMults.push_back(1);
+        }
+    }
+
+    // the arrays refer to the buffers, Geom_BSplineCurve copies them once.
+    const int aNbKnots = (int)m_SplineDistinctKnots.size();
+    TColgp_Array1OfPnt aPoles(m_SplinePoles[0], 1, aNbPoles);
+    TColStd_Array1OfReal aKnots(m_SplineDistinctKnots[0], 1, aNbKnots);
+    TColStd_Array1OfInteger aMults(m_SplineMults[0], 1, aNbKnots);
+
+    if (m_SplineRational)
+    {
+        TColStd_Array1OfReal aWeights(m_SplineWeights[0], 1, aNbPoles);
+        return new Geom_BSplineCurve(aPoles, aWeights, aKnots, aMults, m_SplineDegree);
+    }
+
+    return new Geom_BSplineCurve(aPoles, aKnots, aMults, m_SplineDegree);
+}
+
+Handle(Geom_BSplineCurve) DxfReader::interpolateBSpline(void)
+{
+    const int aNbPoints = (int)m_SplineFitPoints.size();
+
+    Handle(TColgp_HArray1OfPnt) aPoints = new TColgp_HArray1OfPnt(1, aNbPoints);
+    for (int i = 0; i < aNbPoints; ++i)
+    {
+        aPoints->SetValue(i + 1, m_SplineFitPoints[i]);
+    }
+
+    GeomAPI_Interpolate anInterpolate(aPoints, Standard_False, Precision::Confusion());
+
+    // tangents are optional, zero if not given.
+    if (m_SplineStartTangent.SquareMagnitude() > gp::Resolution() &&
+        m_SplineEndTangent.SquareMagnitude() > gp::Resolution())
+    {
+        anInterpolate.Load(m_SplineStartTangent, m_SplineEndTangent);
+    }
+
+    anInterpolate.Perform();
+    if (!anInterpolate.IsDone())
+    {
+        return Handle(Geom_BSplineCurve)();
+    }
+
+    return anInterpolate.Curve();
 }
 
 void DxfReader::add3dFace(const DL_3dFaceData& face)
@@ -103,7 +778,7 @@ void DxfReader::add3dFace(const DL_3dFaceData& face)
 
     if (makeFace.IsDone())
     {
-        m_Builder.Add(m_Shape, makeFace.Face());
+        addShape(makeFace.Face(), face.x[0], face.y[0]);
     }
 }
 
@@ -111,3 +786,187 @@ void DxfReader::addSolid(const DL_SolidData &solid)
 {
     add3dFace(solid);
 }
+
+void DxfReader::addBlock(const DL_BlockData& block)
+{
+    endPolyline();
+    endSpline();
+
+    // a block defined twice keeps the first definition, the entities of
+    // the second go to a scratch block.
+    std::pair<std::map<std::string, Block>::iterator, bool> anInserted =
+        m_Blocks.insert(std::make_pair(block.name, Block()));
+
+    m_CurrentBlock = anInserted.second ? &anInserted.first->second : &m_IgnoredBlock;
+    m_CurrentBlock->Inserts.clear();
+    m_CurrentBlock->Base.SetCoord(block.bpx, block.bpy, block.bpz);
+    m_Builder.MakeCompound(m_CurrentBlock->Shape);
+}
+
+void DxfReader::endBlock()
+{
+    endPolyline();
+    endSpline();
+
+    m_CurrentBlock = NULL;
+}
+
+void DxfReader::addInsert(const DL_InsertData& insert)
+{
+    // nested inserts may refer to blocks defined later in the section.
+    if (m_CurrentBlock != NULL)
+    {
+        m_CurrentBlock->Inserts.push_back(Insert(insert));
+        m_CurrentBlock->Inserts.back().Layer = attributes.getLayer();
+        return;
+    }
+
+    makeInsert(insert, attributes.getLayer(), NULL);
+}
+
+const TopoDS_Shape& DxfReader::getBlock(const std::string& theName)
+{
+    static const TopoDS_Shape THE_NULL_SHAPE;
+
+    std::map<std::string, Block>::iterator it = m_Blocks.find(theName);
+    if (it == m_Blocks.end())
+    {
+        return THE_NULL_SHAPE;
+    }
+
+    Block& aBlock = it->second;
+    if (!aBlock.IsResolved)
+    {
+        // a block inserting itself.
+        if (aBlock.IsResolving)
+        {
+            return THE_NULL_SHAPE;
+        }
+
+        aBlock.IsResolving = true;
+        for (size_t i = 0; i < aBlock.Inserts.size(); ++i)
+        {
+            makeInsert(aBlock.Inserts[i].Data, aBlock.Inserts[i].Layer, &aBlock.Shape);
+        }
+        aBlock.Inserts.clear();
+        aBlock.IsResolving = false;
+        aBlock.IsResolved = true;
+    }
+
+    if (aBlock.Shape.IsNull() || !TopoDS_Iterator(aBlock.Shape).More())
+    {
+        return THE_NULL_SHAPE;
+    }
+
+    return aBlock.Shape;
+}
+
+void DxfReader::makeInsert(const DL_InsertData& theInsert, const std::string& theLayer, TopoDS_Compound* theTarget)
+{
+    TopoDS_Shape aShape = getBlock(theInsert.name);
+    if (aShape.IsNull())
+    {
+        return;
+    }
+
+    const gp_Pnt aBase = m_Blocks.find(theInsert.name)->second.Base;
+    const double aTol = Precision::Confusion();
+    const double sx = theInsert.sx != 0.0 ? theInsert.sx : 1.0;
+    const double sy = theInsert.sy != 0.0 ? theInsert.sy : 1.0;
+    const double sz = theInsert.sz != 0.0 ? theInsert.sz : 1.0;
+    const double aScale = Abs(sx);
+
+    gp_Trsf aToBase;
+    aToBase.SetTranslation(gp_Vec(aBase, gp::Origin()));
+
+    // only rotation and translation go into the location of the shared
+    // block shape, scaled or mirrored locations are rejected by newer OCCT
+    // and not handled by meshing and HLR. Other inserts bake the scale
+    // into a copy of the geometry, shared by all array cells.
+    const bool isUnit = Abs(sx - 1.0) <= aTol && Abs(sy - 1.0) <= aTol && Abs(sz - 1.0) <= aTol;
+    if (!isUnit && Abs(Abs(sy) - aScale) <= aTol * aScale && Abs(Abs(sz) - aScale) <= aTol * aScale)
+    {
+        gp_Trsf aScaling;
+        aScaling.SetScale(gp::Origin(), aScale);
+
+        gp_Trsf aMirror;
+        if (sx < 0.0)
+        {
+            aMirror.SetMirror(gp_Ax2(gp::Origin(), gp::DX()));
+            aScaling.PreMultiply(aMirror);
+        }
+        if (sy < 0.0)
+        {
+            aMirror.SetMirror(gp_Ax2(gp::Origin(), gp::DY()));
+            aScaling.PreMultiply(aMirror);
+        }
+        if (sz < 0.0)
+        {
+            aMirror.SetMirror(gp_Ax2(gp::Origin(), gp::DZ()));
+            aScaling.PreMultiply(aMirror);
+        }
+
+        BRepBuilderAPI_Transform aTransform(aShape, aScaling * aToBase, Standard_True);
+        if (!aTransform.IsDone())
+        {
+            return;
+        }
+
+        aShape = aTransform.Shape();
+        aToBase = gp_Trsf();
+    }
+    else if (!isUnit)
+    {
+        gp_GTrsf aGTrsf;
+        aGTrsf.SetValue(1, 1, sx);
+        aGTrsf.SetValue(2, 2, sy);
+        aGTrsf.SetValue(3, 3, sz);
+        aGTrsf.SetTranslationPart(gp_XYZ(-sx * aBase.X(), -sy * aBase.Y(), -sz * aBase.Z()));
+
+        BRepBuilderAPI_GTransform aTransform(aShape, aGTrsf, Standard_True);
+        if (!aTransform.IsDone())
+        {
+            return;
+        }
+
+        aShape = aTransform.Shape();
+        aToBase = gp_Trsf();
+    }
+
+    const double anAngle = theInsert.angle * M_PI / 180.0;
+    gp_Trsf aRotation;
+    aRotation.SetRotation(gp::OZ(), anAngle);
+
+    const gp_Trsf aPlacement = aRotation * aToBase;
+
+    const int aCols = Max(theInsert.cols, 1);
+    const int aRows = Max(theInsert.rows, 1);
+    const double aCos = cos(anAngle);
+    const double aSin = sin(anAngle);
+
+    for (int r = 0; r < aRows; ++r)
+    {
+        for (int c = 0; c < aCols; ++c)
+        {
+            // array spacing runs along the rotated block axes.
+            const double dx = c * theInsert.colSp;
+            const double dy = r * theInsert.rowSp;
+            const double x = theInsert.ipx + dx * aCos - dy * aSin;
+            const double y = theInsert.ipy + dx * aSin + dy * aCos;
+
+            gp_Trsf aMove;
+            aMove.SetTranslation(gp_Vec(x, y, theInsert.ipz));
+
+            TopoDS_Shape anInstance = aShape.Located(TopLoc_Location(aMove * aPlacement));
+
+            if (theTarget != NULL)
+            {
+                m_Builder.Add(*theTarget, anInstance);
+            }
+            else
+            {
+                addShape(anInstance, theLayer, x, y);
+            }
+        }
+    }
+}
@@ -3,9 +3,19 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include <gp_Pnt.hxx>
+#include <gp_Vec.hxx>
+#include <gp_Trsf.hxx>
+#include <Geom_BSplineCurve.hxx>
 #include <TopoDS_Shape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Vertex.hxx>
 #include <BRep_Builder.hxx>
 
 #include "dl_dxf.h"
@@ -13,6 +23,14 @@
 
 /**
 * @breif Facade dxflib for OpenCascade DataExchange with DXF.
+*
+* Entities are collected in one compound per layer, and per tile if a
+* tile size is given, so that large drawings can be displayed as many
+* small presentations.
+*
+* Blocks are built once, every INSERT adds located instances sharing the
+* TShape of the block. Scaled or mirrored inserts get a transformed copy
+* of the block, the location only carries rotation and translation.
 */
 class DxfReader : public DL_CreationAdapter
 {
@@ -20,16 +38,42 @@ public:
     /**
     * @brief constructor.
     * @param fileName [in] dxf file name with path.
+    * @param tileSize [in] split layers into square tiles of this size, 0 for no tiles.
     */
-    DxfReader(const std::string& fileName);
+    DxfReader(const std::string& fileName, double tileSize = 0.0);
     ~DxfReader(void);
 
     /**
     * @brief Get the shape of the dxf.
-    * @return OpenCascade topology shape.
+    * @return OpenCascade topology shape, a compound of all parts.
     */
     const TopoDS_Shape& GetShape(void) const;
 
+    /**
+    * @brief Get the number of parts (layers or layer tiles).
+    */
+    int NbParts(void) const;
+
+    /**
+    * @brief Get the shape of a part.
+    * @param theIndex [in] index of the part, 0 <= theIndex < NbParts().
+    */
+    const TopoDS_Shape& GetPart(int theIndex) const;
+
+    /**
+    * @brief Get the layer name of a part.
+    * @param theIndex [in] index of the part, 0 <= theIndex < NbParts().
+    */
+    const std::string& GetPartLayer(int theIndex) const;
+
+    /**
+    * @brief Chain the loose edges of every part into wires sharing their
+    * vertices, optionally making planar faces from the closed wires.
+    * @param theTolerance [in] distance up to which edge ends are merged.
+    * @param theMakeFaces [in] replace closed planar wires by faces.
+    */
+    void ConnectEdges(double theTolerance, bool theMakeFaces = false);
+
 public:
     virtual void addPoint(const DL_PointData&);
     virtual void addLine(const DL_LineData& line);
@@ -39,20 +83,145 @@ public:
 
     virtual void addPolyline(const DL_PolylineData& polyline);
     virtual void addVertex(const DL_VertexData&);
+    virtual void endEntity();
 
     virtual void addSpline(const DL_SplineData&);
     virtual void addKnot(const DL_KnotData&);
     virtual void addControlPoint(const DL_ControlPointData&);
+    virtual void addFitPoint(const DL_FitPointData&);
 
     virtual void add3dFace(const DL_3dFaceData&);
     virtual void addSolid(const DL_SolidData& solid);
 
+    virtual void addBlock(const DL_BlockData& block);
+    virtual void endBlock();
+    virtual void addInsert(const DL_InsertData& insert);
+
+private:
+    /**
+    * @brief Add the shape to the part of the current layer and of the tile at x, y.
+    */
+    void addShape(const TopoDS_Shape& theShape, double x, double y);
+    void addShape(const TopoDS_Shape& theShape, const std::string& theLayer, double x, double y);
+
+    /**
+    * @brief Build one wire from the collected polyline vertices.
+    */
+    void endPolyline(void);
+
+    /**
+    * @brief Make a line or, for a non zero bulge, an arc edge between two polyline vertices.
+    */
+    TopoDS_Edge makeSegment(const gp_Pnt& theStart, const gp_Pnt& theEnd,
+        const TopoDS_Vertex& theStartVertex, const TopoDS_Vertex& theEndVertex, double theBulge);
+
+    /**
+    * @brief Build one edge from the collected spline data.
+    */
+    void endSpline(void);
+
+    /**
+    * @brief Make the B-spline from control points, weights and knots.
+    */
+    Handle(Geom_BSplineCurve) makeBSpline(void);
+
+    /**
+    * @brief Make the B-spline through the fit points, for splines without control points.
+    */
+    Handle(Geom_BSplineCurve) interpolateBSpline(void);
+
+    /**
+    * @brief Get the shape of a block, with its nested inserts resolved on first use.
+    * @return null shape for unknown, empty or recursive blocks.
+    */
+    const TopoDS_Shape& getBlock(const std::string& theName);
+
+    /**
+    * @brief Add the instances of an insert, one per array cell.
+    * @param theTarget [in] compound of the parent block, null for the parts.
+    */
+    void makeInsert(const DL_InsertData& theInsert, const std::string& theLayer, TopoDS_Compound* theTarget);
+
+    /**
+    * @brief Copy the part with its loose edges chained into wires or faces.
+    */
+    TopoDS_Compound connectEdges(const TopoDS_Compound& thePart, double theTolerance, bool theMakeFaces);
+
+private:
+    struct Part
+    {
+        std::string Layer;
+        TopoDS_Compound Shape;
+    };
+
+    // layer name and tile index.
+    typedef std::pair<std::string, std::pair<int, int> > PartKey;
+
+    struct Insert
+    {
+        Insert(const DL_InsertData& theData) : Data(theData) {}
+
+        DL_InsertData Data;
+        std::string Layer;
+    };
+
+    struct Block
+    {
+        Block(void) : Base(0.0, 0.0, 0.0), IsResolved(false), IsResolving(false) {}
+
+        TopoDS_Compound Shape;
+        gp_Pnt Base;
+
+        // nested inserts, resolved when the block is used first.
+        std::vector<Insert> Inserts;
+        bool IsResolved;
+        bool IsResolving;
+    };
+
 private:
     std::auto_ptr<DL_Dxf> m_Dxf;
 
     TopoDS_Compound m_Shape;
 
     BRep_Builder m_Builder;
+
+    double m_TileSize;
+
+    std::vector<Part> m_Parts;
+
+    std::map<PartKey, int> m_PartIndex;
+
+    // part of the previous entity, usually the same layer and tile.
+    PartKey m_LastKey;
+    int m_LastPart;
+
+    // current polyline, vertices as x, y, z, bulge.
+    bool m_InPolyline;
+    int m_PolylineFlags;
+    double m_PolylineElevation;
+    std::string m_PolylineLayer;
+    std::vector<double> m_PolylineVertices;
+
+    // current spline.
+    bool m_InSpline;
+    int m_SplineDegree;
+    bool m_SplineRational;
+    std::vector<gp_Pnt> m_SplinePoles;
+    std::vector<double> m_SplineWeights;
+    std::vector<double> m_SplineKnots;
+    std::vector<double> m_SplineDistinctKnots;
+    std::vector<int> m_SplineMults;
+    std::vector<gp_Pnt> m_SplineFitPoints;
+    gp_Vec m_SplineStartTangent;
+    gp_Vec m_SplineEndTangent;
+
+    std::map<std::string, Block> m_Blocks;
+
+    // block being read, null in the entities section.
+    Block* m_CurrentBlock;
+
+    // target of duplicate block definitions.
+    Block m_IgnoredBlock;
 };
 
 #endif // DXFREADER_H
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "dxfWriter.h"
+
+#include <gp_Circ.hxx>
+#include <gp_Elips.hxx>
+
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+
+#include <Geom_Curve.hxx>
+#include <Geom_TrimmedCurve.hxx>
+#include <GeomConvert.hxx>
+#include <GeomConvert_ApproxCurve.hxx>
+
+#include <TopoDS.hxx>
+#include <TopExp_Explorer.hxx>
+
+#include <BRep_Tool.hxx>
+#include <BRepLib.hxx>
+#include <BRepAdaptor_Curve.hxx>
+
+#include <HLRAlgo_Projector.hxx>
+#include <HLRBRep_Algo.hxx>
+#include <HLRBRep_HLRToShape.hxx>
+
+// size of the output buffer of the dxf writer.
+static const size_t THE_BUFFER_SIZE = 1 << 20;
+
+DxfWriter::DxfWriter(const std::string& fileName) : m_Dxf(new DL_Dxf()),
+    m_Attributes("0", 256, -1, "BYLAYER", 1.0)
+{
+    m_Writer.reset(m_Dxf->out(fileName.c_str(), DL_VERSION_2000, THE_BUFFER_SIZE));
+    if (m_Writer.get() == NULL)
+    {
+        return;
+    }
+
+    DL_WriterA& dw = *m_Writer;
+
+    m_Dxf->writeHeader(dw);
+    dw.sectionEnd();
+
+    dw.sectionTables();
+    m_Dxf->writeVPort(dw);
+
+    dw.tableLinetypes(3);
+    m_Dxf->writeLinetype(dw, DL_LinetypeData("BYBLOCK", "BYBLOCK", 0, 0, 0.0));
+    m_Dxf->writeLinetype(dw, DL_LinetypeData("BYLAYER", "BYLAYER", 0, 0, 0.0));
+    m_Dxf->writeLinetype(dw, DL_LinetypeData("CONTINUOUS", "Continuous", 0, 0, 0.0));
+    dw.tableEnd();
+
+    dw.tableLayers(1);
+    m_Dxf->writeLayer(dw, DL_LayerData("0", 0), DL_Attributes("", DL_Codes::black, 100, "CONTINUOUS", 1.0));
+    dw.tableEnd();
+
+    dw.tableStyle(1);
+    m_Dxf->writeStyle(dw, DL_StyleData("standard", 0, 2.5, 1.0, 0.0, 0, 2.5, "txt", ""));
+    dw.tableEnd();
+
+    m_Dxf->writeView(dw);
+    m_Dxf->writeUcs(dw);
+
+    dw.tableAppid(1);
+    m_Dxf->writeAppid(dw, "ACAD");
+    dw.tableEnd();
+
+    m_Dxf->writeDimStyle(dw, 1, 1, 1, 1, 1);
+
+    m_Dxf->writeBlockRecord(dw);
+    dw.tableEnd();
+    dw.sectionEnd();
+
+    dw.sectionBlocks();
+    m_Dxf->writeBlock(dw, DL_BlockData("*Model_Space", 0, 0.0, 0.0, 0.0));
+    m_Dxf->writeEndBlock(dw, "*Model_Space");
+    m_Dxf->writeBlock(dw, DL_BlockData("*Paper_Space", 0, 0.0, 0.0, 0.0));
+    m_Dxf->writeEndBlock(dw, "*Paper_Space");
+    m_Dxf->writeBlock(dw, DL_BlockData("*Paper_Space0", 0, 0.0, 0.0, 0.0));
+    m_Dxf->writeEndBlock(dw, "*Paper_Space0");
+    dw.sectionEnd();
+
+    dw.sectionEntities();
+}
+
+DxfWriter::~DxfWriter(void)
+{
+    Close();
+}
+
+bool DxfWriter::IsOpen(void) const
+{
+    return m_Writer.get() != NULL;
+}
+
+void DxfWriter::AddShape(const TopoDS_Shape& theShape)
+{
+    if (!IsOpen() || theShape.IsNull())
+    {
+        return;
+    }
+
+    for (TopExp_Explorer anExp(theShape, TopAbs_EDGE); anExp.More(); anExp.Next())
+    {
+        writeEdge(TopoDS::Edge(anExp.Current()));
+    }
+}
+
+void DxfWriter::AddOutline(const TopoDS_Shape& theShape, const gp_Ax2& theView)
+{
+    if (!IsOpen() || theShape.IsNull())
+    {
+        return;
+    }
+
+    Handle(HLRBRep_Algo) anAlgo = new HLRBRep_Algo();
+    anAlgo->Add(theShape);
+    anAlgo->Projector(HLRAlgo_Projector(theView));
+    anAlgo->Update();
+    anAlgo->Hide();
+
+    HLRBRep_HLRToShape aToShape(anAlgo);
+
+    // visible sharp edges and silhouettes.
+    TopoDS_Shape aVisible = aToShape.VCompound();
+    TopoDS_Shape anOutline = aToShape.OutLineVCompound();
+
+    if (!aVisible.IsNull())
+    {
+        BRepLib::BuildCurves3d(aVisible);
+        AddShape(aVisible);
+    }
+
+    if (!anOutline.IsNull())
+    {
+        BRepLib::BuildCurves3d(anOutline);
+        AddShape(anOutline);
+    }
+}
+
+void DxfWriter::Close(void)
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    DL_WriterA& dw = *m_Writer;
+
+    dw.sectionEnd();
+
+    m_Dxf->writeObjects(dw);
+    m_Dxf->writeObjectsEnd(dw);
+
+    dw.dxfEOF();
+    dw.close();
+
+    m_Writer.reset();
+    m_Written.Clear();
+}
+
+void DxfWriter::writeEdge(const TopoDS_Edge& theEdge)
+{
+    // edges shared by several faces are written once.
+    if (BRep_Tool::Degenerated(theEdge) || !m_Written.Add(theEdge))
+    {
+        return;
+    }
+
+    BRepAdaptor_Curve aCurve(theEdge);
+
+    Standard_Real aFirst = aCurve.FirstParameter();
+    Standard_Real aLast = aCurve.LastParameter();
+
+    switch (aCurve.GetType())
+    {
+    case GeomAbs_Line:
+    {
+        gp_Pnt aStart = aCurve.Value(aFirst);
+        gp_Pnt anEnd = aCurve.Value(aLast);
+
+        m_Dxf->writeLine(*m_Writer, DL_LineData(aStart.X(), aStart.Y(), aStart.Z(), anEnd.X(), anEnd.Y(), anEnd.Z()), m_Attributes);
+        return;
+    }
+    case GeomAbs_Circle:
+    {
+        // ARC and CIRCLE are written without extrusion, so only for circles in XY planes.
+        gp_Circ aCircle = aCurve.Circle();
+        const gp_Dir& aNormal = aCircle.Axis().Direction();
+        if (!aNormal.IsParallel(gp::DZ(), Precision::Angular()))
+        {
+            break;
+        }
+
+        const gp_Pnt& aCenter = aCircle.Location();
+
+        if (aLast - aFirst >= 2.0 * M_PI - Precision::PConfusion())
+        {
+            m_Dxf->writeCircle(*m_Writer, DL_CircleData(aCenter.X(), aCenter.Y(), aCenter.Z(), aCircle.Radius()), m_Attributes);
+            return;
+        }
+
+        // dxf arcs run counter clockwise around +Z.
+        gp_Pnt aStart = aCurve.Value(aFirst);
+        gp_Pnt anEnd = aCurve.Value(aLast);
+        if (aNormal.Z() < 0.0)
+        {
+            std::swap(aStart, anEnd);
+        }
+
+        Standard_Real anAngle1 = atan2(aStart.Y() - aCenter.Y(), aStart.X() - aCenter.X()) * 180.0 / M_PI;
+        Standard_Real anAngle2 = atan2(anEnd.Y() - aCenter.Y(), anEnd.X() - aCenter.X()) * 180.0 / M_PI;
+
+        m_Dxf->writeArc(*m_Writer, DL_ArcData(aCenter.X(), aCenter.Y(), aCenter.Z(), aCircle.Radius(), anAngle1, anAngle2), m_Attributes);
+        return;
+    }
+    case GeomAbs_Ellipse:
+    {
+        gp_Elips anEllipse = aCurve.Ellipse();
+        const gp_Dir& aNormal = anEllipse.Axis().Direction();
+        if (!aNormal.IsParallel(gp::DZ(), Precision::Angular()))
+        {
+            break;
+        }
+
+        const gp_Pnt& aCenter = anEllipse.Location();
+        gp_Vec aMajor = gp_Vec(anEllipse.XAxis().Direction()) * anEllipse.MajorRadius();
+
+        // the parameter runs clockwise for ellipses around -Z.
+        Standard_Real aStart = aFirst;
+        Standard_Real anEnd = aLast;
+        if (aNormal.Z() < 0.0)
+        {
+            aStart = -aLast;
+            anEnd = -aFirst;
+        }
+
+        m_Dxf->writeEllipse(*m_Writer, DL_EllipseData(aCenter.X(), aCenter.Y(), aCenter.Z(),
+            aMajor.X(), aMajor.Y(), aMajor.Z(), anEllipse.MinorRadius() / anEllipse.MajorRadius(), aStart, anEnd), m_Attributes);
+        return;
+    }
+    case GeomAbs_BSplineCurve:
+    {
+        Handle(Geom_BSplineCurve) aSpline = aCurve.BSpline();
+        if (aFirst > aSpline->FirstParameter() + Precision::PConfusion() ||
+            aLast < aSpline->LastParameter() - Precision::PConfusion())
+        {
+            aSpline = Handle(Geom_BSplineCurve)::DownCast(aSpline->Copy());
+            aSpline->Segment(aFirst, aLast);
+        }
+
+        writeBSpline(aSpline);
+        return;
+    }
+    default:
+        break;
+    }
+
+    // everything else as exact B-spline, approximated if it has no exact form.
+    Handle(Geom_Curve) aBasis = aCurve.Curve().Curve();
+    if (aBasis.IsNull())
+    {
+        return;
+    }
+
+    Handle(Geom_TrimmedCurve) aTrimmed = new Geom_TrimmedCurve(aBasis, aFirst, aLast);
+    Handle(Geom_BSplineCurve) aSpline;
+    try
+    {
+        aSpline = GeomConvert::CurveToBSplineCurve(aTrimmed);
+    }
+    catch (Standard_Failure&)
+    {
+        GeomConvert_ApproxCurve anApprox(aTrimmed, Precision::Confusion(), GeomAbs_C2, 100, 8);
+        if (anApprox.HasResult())
+        {
+            aSpline = anApprox.Curve();
+        }
+    }
+
+    if (aSpline.IsNull())
+    {
+        return;
+    }
+
+    if (aCurve.Trsf().Form() != gp_Identity)
+    {
+        aSpline->Transform(aCurve.Trsf());
+    }
+
+    writeBSpline(aSpline);
+}
+
+void DxfWriter::writeBSpline(const Handle(Geom_BSplineCurve)& theSpline)
+{
+    Handle(Geom_BSplineCurve) aSpline = theSpline;
+    if (aSpline->IsPeriodic())
+    {
+        aSpline = Handle(Geom_BSplineCurve)::DownCast(aSpline->Copy());
+        aSpline->SetNotPeriodic();
+    }
+
+    const Standard_Integer aDegree = aSpline->Degree();
+    const Standard_Integer aNbPoles = aSpline->NbPoles();
+    const Standard_Boolean isRational = aSpline->IsRational();
+
+    // 1: closed, 4: rational.
+    int aFlags = 0;
+    if (aSpline->IsClosed())
+    {
+        aFlags |= 1;
+    }
+    if (isRational)
+    {
+        aFlags |= 4;
+    }
+
+    DL_WriterA& dw = *m_Writer;
+
+    m_Dxf->writeSpline(dw, DL_SplineData(aDegree, aNbPoles + aDegree + 1, aNbPoles, 0, aFlags), m_Attributes);
+
+    // dxf expects the flat knot sequence.
+    for (Standard_Integer i = 1; i <= aSpline->NbKnots(); ++i)
+    {
+        for (Standard_Integer m = 0; m < aSpline->Multiplicity(i); ++m)
+        {
+            m_Dxf->writeKnot(dw, DL_KnotData(aSpline->Knot(i)));
+        }
+    }
+
+    if (isRational)
+    {
+        for (Standard_Integer i = 1; i <= aNbPoles; ++i)
+        {
+            dw.dxfReal(41, aSpline->Weight(i));
+        }
+    }
+
+    for (Standard_Integer i = 1; i <= aNbPoles; ++i)
+    {
+        const gp_Pnt& aPole = aSpline->Pole(i);
+        m_Dxf->writeControlPoint(dw, DL_ControlPointData(aPole.X(), aPole.Y(), aPole.Z(), aSpline->Weight(i)));
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef DXFWRITER_H
+#define DXFWRITER_H
+
+#pragma once
+
+#include <memory>
+
+#include <gp_Ax2.hxx>
+#include <TopoDS_Shape.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopTools_MapOfShape.hxx>
+#include <Geom_BSplineCurve.hxx>
+
+#include "dl_dxf.h"
+#include "dl_writer_ascii.h"
+
+/**
+* @breif Facade dxflib for writing the edges of OpenCascade shapes to DXF.
+*
+* Edges are streamed from TopExp_Explorer to a buffered DL_WriterA.
+* Lines, circles, arcs and ellipses become LINE, CIRCLE, ARC and ELLIPSE
+* entities, every other curve an exact SPLINE. Nothing is tessellated.
+*/
+class DxfWriter
+{
+public:
+    /**
+    * @brief constructor, creates the file and writes header, tables and blocks.
+    * @param fileName [in] dxf file name with path.
+    */
+    DxfWriter(const std::string& fileName);
+    ~DxfWriter(void);
+
+    /**
+    * @brief Check whether the file could be created.
+    */
+    bool IsOpen(void) const;
+
+    /**
+    * @brief Write all edges of the shape, shared edges only once.
+    * @param theShape [in] shape to export.
+    */
+    void AddShape(const TopoDS_Shape& theShape);
+
+    /**
+    * @brief Write the visible edges and outlines of the shape projected
+    * into the XY plane of the view.
+    * @param theShape [in] shape to export.
+    * @param theView [in] view coordinate system, looking along -Z.
+    */
+    void AddOutline(const TopoDS_Shape& theShape, const gp_Ax2& theView);
+
+    /**
+    * @brief Finish the ENTITIES section and close the file.
+    */
+    void Close(void);
+
+private:
+    void writeEdge(const TopoDS_Edge& theEdge);
+    void writeBSpline(const Handle(Geom_BSplineCurve)& theSpline);
+
+private:
+    std::auto_ptr<DL_Dxf> m_Dxf;
+
+    std::auto_ptr<DL_WriterA> m_Writer;
+
+    DL_Attributes m_Attributes;
+
+    TopTools_MapOfShape m_Written;
+};
+
+#endif // DXFWRITER_H
@@ -1,3 +1,24 @@
 # dxflib
-INCLUDEPATH += $$PWD\src
-LIBS += $$PWD\bin\dxflib.lib
\ No newline at end of file
+# the sources are compiled into the project, so the mapped, parallel and
+# binary readers and the buffered writer are always up to date.
+INCLUDEPATH += $$PWD/src
+
+SOURCES += \
+    $$PWD/src/dl_dxf.cpp \
+    $$PWD/src/dl_mappedfile.cpp \
+    $$PWD/src/dl_writer_ascii.cpp
+
+HEADERS += \
+    $$PWD/src/dl_attributes.h \
+    $$PWD/src/dl_codes.h \
+    $$PWD/src/dl_creationadapter.h \
+    $$PWD/src/dl_creationinterface.h \
+    $$PWD/src/dl_creationrecorder.h \
+    $$PWD/src/dl_dxf.h \
+    $$PWD/src/dl_entities.h \
+    $$PWD/src/dl_exception.h \
+    $$PWD/src/dl_extrusion.h \
+    $$PWD/src/dl_global.h \
+    $$PWD/src/dl_mappedfile.h \
+    $$PWD/src/dl_writer.h \
+    $$PWD/src/dl_writer_ascii.h
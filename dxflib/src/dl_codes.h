@@ -58,6 +58,11 @@
 #define DL_DXF_MAXLINE 1024
 #define DL_DXF_MAXGROUPCODE 1100
 
+// Start of binary DXF files:
+#define DL_DXF_BINARY_SENTINEL "AutoCAD Binary DXF\r\n\x1a"
+// Size of the sentinel including the terminating 0:
+#define DL_DXF_BINARY_SENTINEL_SIZE 22
+
 // used to mark invalid vectors:
 //#define DL_DXF_MAXDOUBLE 1.0E+10
 
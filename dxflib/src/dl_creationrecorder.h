@@ -0,0 +1,304 @@
+/****************************************************************************
+** Copyright (C) 2001-2013 RibbonSoft, GmbH. All rights reserved.
+**
+** This file is part of the dxflib project.
+**
+** This file is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** Licensees holding valid dxflib Professional Edition licenses may use
+** this file in accordance with the dxflib Commercial License
+** Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.ribbonsoft.com for further details.
+**
+** Contact info@ribbonsoft.com if any conditions of this licensing are
+** not clear to you.
+**
+**********************************************************************/
+
+#ifndef DL_CREATIONRECORDER_H
+#define DL_CREATIONRECORDER_H
+
+#include "dl_global.h"
+
+#include <functional>
+#include <vector>
+
+#include "dl_creationadapter.h"
+
+/**
+ * Creation interface which records all calls and replays them later
+ * on another creation interface in the same order.
+ *
+ * Used by DL_Dxf::inParallel() to parse parts of the ENTITIES section
+ * on worker threads while the user's creation interface is only ever
+ * called from the reading thread.
+ *
+ * Attributes and extrusion set by DL_Dxf through the non virtual
+ * setAttributes() / setExtrusion() are recorded before the first
+ * callback that follows a group code / value pair.
+ */
+class DXFLIB_EXPORT DL_CreationRecorder : public DL_CreationAdapter {
+public:
+    typedef std::function<void(DL_CreationInterface*)> Call;
+
+    DL_CreationRecorder() : stateRecorded(false) {}
+    virtual ~DL_CreationRecorder() {}
+
+    /**
+     * Calls all recorded functions on the given creation interface.
+     */
+    void replay(DL_CreationInterface* creationInterface) const {
+        std::string groupValue;
+        size_t call = 0;
+        for (size_t i=0; i<pairs.size(); ++i) {
+            const Pair& pair = pairs[i];
+            for (; call<pair.callsBefore; ++call) {
+                calls[call](creationInterface);
+            }
+            groupValue.assign(pairValues, pair.valueOffset, pair.valueLength);
+            creationInterface->processCodeValuePair(pair.groupCode, groupValue);
+        }
+        for (; call<calls.size(); ++call) {
+            calls[call](creationInterface);
+        }
+    }
+
+    virtual void processCodeValuePair(unsigned int groupCode, const std::string& groupValue) {
+        // DL_Dxf may change attributes and extrusion after this call:
+        stateRecorded = false;
+
+        // Pairs are stored in one buffer, one std::function per pair
+        // would cost more than parsing them:
+        Pair pair;
+        pair.groupCode = groupCode;
+        pair.valueOffset = pairValues.size();
+        pair.valueLength = groupValue.size();
+        pair.callsBefore = calls.size();
+        pairs.push_back(pair);
+        pairValues.append(groupValue);
+    }
+    virtual void endSection() {
+        record([=](DL_CreationInterface* ci) { ci->endSection(); });
+    }
+    virtual void addLayer(const DL_LayerData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addLayer(data); });
+    }
+    virtual void addLinetype(const DL_LinetypeData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addLinetype(data); });
+    }
+    virtual void addLinetypeDash(double length) {
+        record([=](DL_CreationInterface* ci) { ci->addLinetypeDash(length); });
+    }
+    virtual void addBlock(const DL_BlockData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addBlock(data); });
+    }
+    virtual void endBlock() {
+        record([=](DL_CreationInterface* ci) { ci->endBlock(); });
+    }
+    virtual void addTextStyle(const DL_StyleData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addTextStyle(data); });
+    }
+    virtual void addPoint(const DL_PointData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addPoint(data); });
+    }
+    virtual void addLine(const DL_LineData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addLine(data); });
+    }
+    virtual void addXLine(const DL_XLineData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addXLine(data); });
+    }
+    virtual void addRay(const DL_RayData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addRay(data); });
+    }
+    virtual void addArc(const DL_ArcData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addArc(data); });
+    }
+    virtual void addCircle(const DL_CircleData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addCircle(data); });
+    }
+    virtual void addEllipse(const DL_EllipseData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addEllipse(data); });
+    }
+    virtual void addPolyline(const DL_PolylineData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addPolyline(data); });
+    }
+    virtual void addVertex(const DL_VertexData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addVertex(data); });
+    }
+    virtual void addSpline(const DL_SplineData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addSpline(data); });
+    }
+    virtual void addControlPoint(const DL_ControlPointData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addControlPoint(data); });
+    }
+    virtual void addFitPoint(const DL_FitPointData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addFitPoint(data); });
+    }
+    virtual void addKnot(const DL_KnotData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addKnot(data); });
+    }
+    virtual void addInsert(const DL_InsertData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addInsert(data); });
+    }
+    virtual void addTrace(const DL_TraceData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addTrace(data); });
+    }
+    virtual void add3dFace(const DL_3dFaceData& data) {
+        record([=](DL_CreationInterface* ci) { ci->add3dFace(data); });
+    }
+    virtual void addSolid(const DL_SolidData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addSolid(data); });
+    }
+    virtual void addMText(const DL_MTextData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addMText(data); });
+    }
+    virtual void addMTextChunk(const std::string& text) {
+        record([=](DL_CreationInterface* ci) { ci->addMTextChunk(text); });
+    }
+    virtual void addText(const DL_TextData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addText(data); });
+    }
+    virtual void addArcAlignedText(const DL_ArcAlignedTextData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addArcAlignedText(data); });
+    }
+    virtual void addAttribute(const DL_AttributeData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addAttribute(data); });
+    }
+    virtual void addDimAlign(const DL_DimensionData& data, const DL_DimAlignedData& edata) {
+        record([=](DL_CreationInterface* ci) { ci->addDimAlign(data, edata); });
+    }
+    virtual void addDimLinear(const DL_DimensionData& data, const DL_DimLinearData& edata) {
+        record([=](DL_CreationInterface* ci) { ci->addDimLinear(data, edata); });
+    }
+    virtual void addDimRadial(const DL_DimensionData& data, const DL_DimRadialData& edata) {
+        record([=](DL_CreationInterface* ci) { ci->addDimRadial(data, edata); });
+    }
+    virtual void addDimDiametric(const DL_DimensionData& data, const DL_DimDiametricData& edata) {
+        record([=](DL_CreationInterface* ci) { ci->addDimDiametric(data, edata); });
+    }
+    virtual void addDimAngular(const DL_DimensionData& data, const DL_DimAngular2LData& edata) {
+        record([=](DL_CreationInterface* ci) { ci->addDimAngular(data, edata); });
+    }
+    virtual void addDimAngular3P(const DL_DimensionData& data, const DL_DimAngular3PData& edata) {
+        record([=](DL_CreationInterface* ci) { ci->addDimAngular3P(data, edata); });
+    }
+    virtual void addDimOrdinate(const DL_DimensionData& data, const DL_DimOrdinateData& edata) {
+        record([=](DL_CreationInterface* ci) { ci->addDimOrdinate(data, edata); });
+    }
+    virtual void addLeader(const DL_LeaderData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addLeader(data); });
+    }
+    virtual void addLeaderVertex(const DL_LeaderVertexData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addLeaderVertex(data); });
+    }
+    virtual void addHatch(const DL_HatchData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addHatch(data); });
+    }
+    virtual void addImage(const DL_ImageData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addImage(data); });
+    }
+    virtual void linkImage(const DL_ImageDefData& data) {
+        record([=](DL_CreationInterface* ci) { ci->linkImage(data); });
+    }
+    virtual void addHatchLoop(const DL_HatchLoopData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addHatchLoop(data); });
+    }
+    virtual void addHatchEdge(const DL_HatchEdgeData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addHatchEdge(data); });
+    }
+    virtual void addXRecord(const std::string& handle) {
+        record([=](DL_CreationInterface* ci) { ci->addXRecord(handle); });
+    }
+    virtual void addXRecordString(int code, const std::string& value) {
+        record([=](DL_CreationInterface* ci) { ci->addXRecordString(code, value); });
+    }
+    virtual void addXRecordReal(int code, double value) {
+        record([=](DL_CreationInterface* ci) { ci->addXRecordReal(code, value); });
+    }
+    virtual void addXRecordInt(int code, int value) {
+        record([=](DL_CreationInterface* ci) { ci->addXRecordInt(code, value); });
+    }
+    virtual void addXRecordBool(int code, bool value) {
+        record([=](DL_CreationInterface* ci) { ci->addXRecordBool(code, value); });
+    }
+    virtual void addXDataApp(const std::string& appId) {
+        record([=](DL_CreationInterface* ci) { ci->addXDataApp(appId); });
+    }
+    virtual void addXDataString(int code, const std::string& value) {
+        record([=](DL_CreationInterface* ci) { ci->addXDataString(code, value); });
+    }
+    virtual void addXDataReal(int code, double value) {
+        record([=](DL_CreationInterface* ci) { ci->addXDataReal(code, value); });
+    }
+    virtual void addXDataInt(int code, int value) {
+        record([=](DL_CreationInterface* ci) { ci->addXDataInt(code, value); });
+    }
+    virtual void addDictionary(const DL_DictionaryData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addDictionary(data); });
+    }
+    virtual void addDictionaryEntry(const DL_DictionaryEntryData& data) {
+        record([=](DL_CreationInterface* ci) { ci->addDictionaryEntry(data); });
+    }
+    virtual void endEntity() {
+        record([=](DL_CreationInterface* ci) { ci->endEntity(); });
+    }
+    virtual void addComment(const std::string& comment) {
+        record([=](DL_CreationInterface* ci) { ci->addComment(comment); });
+    }
+    virtual void setVariableVector(const std::string& key, double v1, double v2, double v3, int code) {
+        record([=](DL_CreationInterface* ci) { ci->setVariableVector(key, v1, v2, v3, code); });
+    }
+    virtual void setVariableString(const std::string& key, const std::string& value, int code) {
+        record([=](DL_CreationInterface* ci) { ci->setVariableString(key, value, code); });
+    }
+    virtual void setVariableInt(const std::string& key, int value, int code) {
+        record([=](DL_CreationInterface* ci) { ci->setVariableInt(key, value, code); });
+    }
+    virtual void setVariableDouble(const std::string& key, double value, int code) {
+        record([=](DL_CreationInterface* ci) { ci->setVariableDouble(key, value, code); });
+    }
+    virtual void endSequence() {
+        record([=](DL_CreationInterface* ci) { ci->endSequence(); });
+    }
+
+private:
+    void record(const Call& call) {
+        if (!stateRecorded) {
+            DL_Attributes attrib = attributes;
+            double dx = extrusion->getDirection()[0];
+            double dy = extrusion->getDirection()[1];
+            double dz = extrusion->getDirection()[2];
+            double elevation = extrusion->getElevation();
+            calls.push_back([=](DL_CreationInterface* ci) {
+                ci->setAttributes(attrib);
+                ci->setExtrusion(dx, dy, dz, elevation);
+            });
+            stateRecorded = true;
+        }
+        calls.push_back(call);
+    }
+
+    struct Pair {
+        unsigned int groupCode;
+        size_t valueOffset;
+        size_t valueLength;
+        // number of calls recorded before this pair:
+        size_t callsBefore;
+    };
+
+    std::vector<Call> calls;
+    std::vector<Pair> pairs;
+    std::string pairValues;
+    bool stateRecorded;
+};
+
+#endif
+
+// EOF
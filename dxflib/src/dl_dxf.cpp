@@ -29,10 +29,24 @@
 #include <cstdio>
 #include <cassert>
 #include <cmath>
+#include <cfloat>
+#include <clocale>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <locale.h>
+#elif defined(__APPLE__)
+#include <xlocale.h>
+#endif
 
 #include "dl_attributes.h"
 #include "dl_codes.h"
 #include "dl_creationadapter.h"
+#include "dl_creationrecorder.h"
+#include "dl_mappedfile.h"
 #include "dl_writer_ascii.h"
 
 #include "iostream"
@@ -65,6 +79,24 @@ DL_Dxf::DL_Dxf() {
     leaderVertices = NULL;
     maxLeaderVertices = 0;
     leaderVertexIndex = 0;
+
+    groupReal = 0.0;
+    groupRealValid = false;
+    binaryCodeSize = 2;
+
+    line = 1;
+    firstCall = true;
+    currentObjectType = DL_UNKNOWN;
+    // files without dxflib comment are treated as written by this version:
+    libVersion = (DL_VERSION_MAJOR<<24) + (DL_VERSION_MINOR<<16) +
+                 (DL_VERSION_REV<<8) + DL_VERSION_BUILD;
+
+    values.resize(DL_DXF_MAXGROUPCODE);
+    valueStamps.resize(DL_DXF_MAXGROUPCODE, 0);
+    realValues.resize(DL_DXF_MAXGROUPCODE, 0.0);
+    realStamps.resize(DL_DXF_MAXGROUPCODE, 0);
+    valueGeneration = 1;
+    firstValueCode = -1;
 }
 
 
@@ -99,6 +131,8 @@ DL_Dxf::~DL_Dxf() {
  * @brief Reads the given file and calls the appropriate functions in
  * the given creation interface for every entity found in the file.
  *
+ * ASCII and binary DXF files are supported.
+ *
  * @param file Input
  *      Path and name of file to read
  * @param creationInterface
@@ -111,12 +145,37 @@ bool DL_Dxf::in(const std::string& file, DL_CreationInterface* creationInterface
     FILE *fp;
     firstCall = true;
     currentObjectType = DL_UNKNOWN;
+    line = 1;
+
+    // Binary DXF is decoded from memory:
+    fp = fopen(file.c_str(), "rb");
+    if (fp==NULL) {
+        return false;
+    }
+    char sentinel[DL_DXF_BINARY_SENTINEL_SIZE];
+    size_t sentinelSize = fread(sentinel, 1, sizeof(sentinel), fp);
+    if (isBinary(sentinel, sentinelSize)) {
+        std::vector<char> data(sentinel, sentinel+sentinelSize);
+        char buf[64*1024];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fp))>0) {
+            data.insert(data.end(), buf, buf+n);
+        }
+        fclose(fp);
+
+        const char* pos = &data[0];
+        const char* end = pos + data.size();
+        while (readDxfGroupsBinary(pos, end, creationInterface)) {}
+        return true;
+    }
+    fclose(fp);
 
     fp = fopen(file.c_str(), "rt");
     if (fp) {
-        std::locale oldLocale = std::locale::global(std::locale("C"));	// use dot in numbers
+        // numbers are converted independent of the locale (see toReal),
+        // the global locale is left alone so that several instances can
+        // read in parallel:
         while (readDxfGroups(fp, creationInterface)) {}
-        std::locale::global(oldLocale);
         fclose(fp);
         return true;
     }
@@ -127,14 +186,17 @@ bool DL_Dxf::in(const std::string& file, DL_CreationInterface* creationInterface
 
 
 /**
- * Reads a DXF file from an existing stream.
+ * Reads a DXF file from an existing stream. Binary DXF is detected by
+ * its sentinel and decoded from memory, the stream must then be opened
+ * in binary mode.
  *
  * @param stream The input stream.
  * @param creationInterface
  *      Pointer to the class which takes care of the entities in the file.
  *
  * @retval true If \p file could be opened.
- * @retval false If \p file could not be opened.
+ * @retval false If \p file could not be opened or starts with neither
+ *      a group code nor the binary sentinel.
  */
 bool DL_Dxf::in(std::istream& stream,
                 DL_CreationInterface* creationInterface) {
@@ -142,6 +204,30 @@ bool DL_Dxf::in(std::istream& stream,
     if (stream.good()) {
         firstCall=true;
         currentObjectType = DL_UNKNOWN;
+        line = 1;
+
+        // ASCII DXF starts with a group code, the binary sentinel with
+        // 'A' ("AutoCAD Binary DXF"):
+        if (stream.peek()=='A') {
+            char sentinel[DL_DXF_BINARY_SENTINEL_SIZE];
+            stream.read(sentinel, sizeof(sentinel));
+            size_t sentinelSize = (size_t)stream.gcount();
+            if (!isBinary(sentinel, sentinelSize)) {
+                return false;
+            }
+
+            std::vector<char> data(sentinel, sentinel+sentinelSize);
+            char buf[64*1024];
+            while (stream.read(buf, sizeof(buf)) || stream.gcount()>0) {
+                data.insert(data.end(), buf, buf+stream.gcount());
+            }
+
+            const char* pos = &data[0];
+            const char* end = pos + data.size();
+            while (readDxfGroupsBinary(pos, end, creationInterface)) {}
+            return true;
+        }
+
         while (readDxfGroups(stream, creationInterface)) {}
         return true;
     }
@@ -150,6 +236,232 @@ bool DL_Dxf::in(std::istream& stream,
 
 
 
+/**
+ * @brief Reads the given file through a read only memory mapping and
+ * calls the appropriate functions in the given creation interface for
+ * every entity found in the file.
+ *
+ * Group couplets are tokenized directly over the mapped file contents,
+ * no line buffers are allocated while reading. This is considerably
+ * faster than in() for large files. Binary DXF files are decoded
+ * directly from the mapping.
+ *
+ * @param file Input
+ *      Path and name of file to read
+ * @param creationInterface
+ *      Pointer to the class which takes care of the entities in the file.
+ *
+ * @retval true If \p file could be opened and mapped.
+ * @retval false If \p file could not be opened or mapped.
+ */
+bool DL_Dxf::inMapped(const std::string& file,
+                      DL_CreationInterface* creationInterface) {
+    DL_MappedFile mappedFile;
+    if (!mappedFile.open(file)) {
+        return false;
+    }
+
+    firstCall = true;
+    currentObjectType = DL_UNKNOWN;
+    line = 1;
+
+    const char* pos = mappedFile.data();
+    const char* end = pos + mappedFile.size();
+
+    if (isBinary(pos, mappedFile.size())) {
+        while (readDxfGroupsBinary(pos, end, creationInterface)) {}
+        return true;
+    }
+
+    while (readDxfGroups(pos, end, creationInterface)) {}
+    return true;
+}
+
+
+
+/**
+ * @brief Reads the given file like inMapped() but parses the ENTITIES
+ * section on several threads.
+ *
+ * HEADER, TABLES and BLOCKS are read sequentially. The ENTITIES section
+ * is then split into chunks at group code 0 boundaries (never inside a
+ * POLYLINE / INSERT sequence), each chunk is parsed by a separate
+ * DL_Dxf instance into a DL_CreationRecorder and the recorded calls
+ * are replayed to \p creationInterface in the original file order.
+ * All calls of \p creationInterface happen on the calling thread and
+ * in the same order as with in().
+ *
+ * @param file Input
+ *      Path and name of file to read
+ * @param creationInterface
+ *      Pointer to the class which takes care of the entities in the file.
+ * @param numThreads Number of worker threads, 0 for one per core.
+ *
+ * @retval true If \p file could be opened and mapped.
+ * @retval false If \p file could not be opened or mapped.
+ */
+bool DL_Dxf::inParallel(const std::string& file,
+                        DL_CreationInterface* creationInterface,
+                        int numThreads) {
+    DL_MappedFile mappedFile;
+    if (!mappedFile.open(file)) {
+        return false;
+    }
+
+    firstCall = true;
+    currentObjectType = DL_UNKNOWN;
+    line = 1;
+
+    const char* pos = mappedFile.data();
+    const char* end = pos + mappedFile.size();
+
+    // Binary DXF has no cheap way to find group boundaries, it is
+    // read sequentially:
+    if (isBinary(pos, mappedFile.size())) {
+        while (readDxfGroupsBinary(pos, end, creationInterface)) {}
+        return true;
+    }
+
+    // Read everything up to the start of the ENTITIES section:
+    bool more = true;
+    bool sectionStart = false;
+    while (more) {
+        more = readDxfGroups(pos, end, creationInterface);
+        if (sectionStart && groupCode==2 && groupValue=="ENTITIES") {
+            break;
+        }
+        sectionStart = (groupCode==0 && groupValue=="SECTION");
+    }
+
+    if (numThreads<=0) {
+        numThreads = (int)std::thread::hardware_concurrency();
+    }
+
+    // Find chunk boundaries (start of a group with code 0) up to and
+    // including the ENDSEC of the ENTITIES section:
+    std::vector<const char*> boundaries;
+    if (more && numThreads>1) {
+        const size_t chunkSize = std::max<size_t>((end-pos)/(numThreads*8), 64*1024);
+        const char* p = pos;
+        const char* code;
+        size_t codeLength;
+        const char* value;
+        size_t valueLength;
+        while (p<end) {
+            const char* group = p;
+            if (!getStrippedLine(code, codeLength, p, end) ||
+                !getStrippedLine(value, valueLength, p, end, false)) {
+                break;
+            }
+            if (codeLength!=1 || code[0]!='0') {
+                continue;
+            }
+            std::string v(value, valueLength);
+            if (v=="ENDSEC") {
+                boundaries.push_back(group);
+                break;
+            }
+            if (boundaries.empty() ||
+                ((size_t)(group-boundaries.back())>=chunkSize &&
+                 v!="VERTEX" && v!="SEQEND" && v!="ATTRIB")) {
+                boundaries.push_back(group);
+            }
+        }
+    }
+
+    if (boundaries.size()<3) {
+        // nothing worth splitting:
+        while (more && readDxfGroups(pos, end, creationInterface)) {}
+        return true;
+    }
+
+    // The first entity of the section is read by this instance to get
+    // the previous section committed:
+    while (pos<=boundaries.front()) {
+        readDxfGroups(pos, end, creationInterface);
+    }
+
+    const size_t numChunks = boundaries.size()-1;
+    std::vector<DL_CreationRecorder*> recorders(numChunks, (DL_CreationRecorder*)NULL);
+    std::vector<bool> done(numChunks, false);
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<bool> cancel(false);
+    std::mutex mutex;
+    std::condition_variable chunkDone;
+    const int version = libVersion;
+
+    std::function<void()> worker = [&]() {
+        for (size_t i = nextChunk++; i<numChunks && !cancel; i = nextChunk++) {
+            DL_CreationRecorder* recorder = new DL_CreationRecorder();
+            DL_CreationAdapter discard;
+            DL_Dxf dxf;
+            dxf.libVersion = version;
+
+            // The first group (code 0) only determines the entity type,
+            // its callbacks belong to the previous chunk:
+            const char* p = boundaries[i];
+            dxf.readDxfGroups(p, end, &discard);
+            while (p<boundaries[i+1]) {
+                dxf.readDxfGroups(p, end, recorder);
+            }
+            // Group which commits the last entity of this chunk:
+            if (p<end) {
+                dxf.readDxfGroups(p, end, recorder);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            recorders[i] = recorder;
+            done[i] = true;
+            chunkDone.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t=0; t<numThreads && t<(int)numChunks; ++t) {
+        threads.push_back(std::thread(worker));
+    }
+
+    try {
+        for (size_t i=0; i<numChunks; ++i) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!done[i]) {
+                    chunkDone.wait(lock);
+                }
+            }
+            recorders[i]->replay(creationInterface);
+            delete recorders[i];
+            recorders[i] = NULL;
+        }
+    }
+    catch (...) {
+        cancel = true;
+        for (size_t t=0; t<threads.size(); ++t) {
+            threads[t].join();
+        }
+        for (size_t i=0; i<numChunks; ++i) {
+            delete recorders[i];
+        }
+        throw;
+    }
+
+    for (size_t t=0; t<threads.size(); ++t) {
+        threads[t].join();
+    }
+
+    // Bring this instance into the state after the last chunk (end of
+    // the ENTITIES section) and continue sequentially:
+    pos = boundaries.back();
+    if (pos<end) {
+        DL_CreationAdapter discard;
+        readDxfGroups(pos, end, &discard);
+        while (readDxfGroups(pos, end, creationInterface)) {}
+    }
+    return true;
+}
+
+
+
 /**
  * @brief Reads a group couplet from a DXF file.  Calls another function
  * to process it.
@@ -174,8 +486,6 @@ bool DL_Dxf::in(std::istream& stream,
  */
 bool DL_Dxf::readDxfGroups(FILE *fp, DL_CreationInterface* creationInterface) {
 
-    static int line = 1;
-
     // Read one group of the DXF file and strip the lines:
     if (DL_Dxf::getStrippedLine(groupCodeTmp, DL_DXF_MAXLINE, fp) &&
             DL_Dxf::getStrippedLine(groupValue, DL_DXF_MAXLINE, fp, false) ) {
@@ -198,8 +508,6 @@ bool DL_Dxf::readDxfGroups(FILE *fp, DL_CreationInterface* creationInterface) {
 bool DL_Dxf::readDxfGroups(std::istream& stream,
                            DL_CreationInterface* creationInterface) {
 
-    static int line = 1;
-
     // Read one group of the DXF file and chop the lines:
     if (DL_Dxf::getStrippedLine(groupCodeTmp, DL_DXF_MAXLINE, stream) &&
             DL_Dxf::getStrippedLine(groupValue, DL_DXF_MAXLINE, stream, false) ) {
@@ -286,6 +594,350 @@ bool DL_Dxf::getStrippedLine(std::string &s, unsigned int size,
 
 
 
+/**
+ * Same as above but for memory mapped input. \p pos is advanced to
+ * the start of the next couplet.
+ */
+bool DL_Dxf::readDxfGroups(const char*& pos, const char* end,
+                           DL_CreationInterface* creationInterface) {
+
+    const char* code;
+    size_t codeLength;
+    const char* value;
+    size_t valueLength;
+
+    // Read one group of the DXF file and strip the lines:
+    if (DL_Dxf::getStrippedLine(code, codeLength, pos, end) &&
+            DL_Dxf::getStrippedLine(value, valueLength, pos, end, false) ) {
+
+        // Same as strtol(code, NULL, 10) without a temporary string:
+        const char* c = code;
+        const char* codeEnd = code + codeLength;
+        bool negative = false;
+        if (c<codeEnd && (*c=='-' || *c=='+')) {
+            negative = (*c=='-');
+            ++c;
+        }
+        int gc = 0;
+        for (; c<codeEnd && *c>='0' && *c<='9'; ++c) {
+            gc = gc*10 + (*c-'0');
+        }
+        groupCode = (unsigned int)(negative ? -gc : gc);
+
+        // reuses the capacity of groupValue, no allocation per line:
+        groupValue.assign(value, valueLength);
+
+        creationInterface->processCodeValuePair(groupCode, groupValue);
+        line+=2;
+        processDXFGroup(creationInterface, groupCode, groupValue);
+    }
+
+    return pos<end;
+}
+
+
+
+/**
+ * @brief Returns the next line of memory mapped input without copying it.
+ *
+ * Leading whitespace and trailing CR/LF are stripped in the same way as
+ * stripWhiteSpace() does.
+ *
+ * @param line Output\n
+ *      Pointer to the first useful character of the line.
+ * @param length Output\n
+ *      Number of useful characters of the line.
+ * @param pos Input and output\n
+ *      Current read position, advanced to the start of the next line.
+ * @param end End of the mapped input.
+ *
+ * @retval true if line could be read
+ * @retval false if \p pos is already at end of input
+ */
+bool DL_Dxf::getStrippedLine(const char*& line, size_t& length,
+                             const char*& pos, const char* end,
+                             bool stripSpace) {
+    if (pos>=end) {
+        line = pos;
+        length = 0;
+        return false;
+    }
+
+    const char* first = pos;
+    const char* last = static_cast<const char*>(memchr(pos, '\n', end-pos));
+    if (last==NULL) {
+        last = end;
+        pos = end;
+    }
+    else {
+        pos = last+1;
+    }
+
+    // Strip trailing CR/LF (and whitespace):
+    while (last>first &&
+           (last[-1]=='\r' ||
+            (stripSpace && (last[-1]==' ' || last[-1]=='\t')))) {
+        --last;
+    }
+
+    // Skip whitespace, excluding \n, at beginning of line
+    if (stripSpace) {
+        while (first<last && (*first==' ' || *first=='\t')) {
+            ++first;
+        }
+    }
+
+    line = first;
+    length = last-first;
+    return true;
+}
+
+
+
+/**
+ * @retval true If \p data starts with the sentinel of a binary DXF file
+ *      ("AutoCAD Binary DXF\r\n\x1a\0").
+ */
+bool DL_Dxf::isBinary(const char* data, size_t size) {
+    return data!=NULL && size>=DL_DXF_BINARY_SENTINEL_SIZE &&
+           memcmp(data, DL_DXF_BINARY_SENTINEL, DL_DXF_BINARY_SENTINEL_SIZE)==0;
+}
+
+
+
+/**
+ * Value types of binary DXF groups.
+ */
+enum DL_BinaryType {
+    DL_BINARY_STRING,
+    DL_BINARY_REAL,
+    DL_BINARY_INT16,
+    DL_BINARY_INT32,
+    DL_BINARY_INT64,
+    DL_BINARY_BOOL,
+    DL_BINARY_CHUNK
+};
+
+/**
+ * @return Type of the value stored for the given group code in binary
+ * DXF files. Codes which are not documented are treated as strings.
+ */
+static DL_BinaryType getBinaryType(int code) {
+    if ((code>=10 && code<=59) || (code>=110 && code<=149) ||
+        (code>=210 && code<=239) || (code>=460 && code<=469) ||
+        (code>=1010 && code<=1059)) {
+        return DL_BINARY_REAL;
+    }
+    if ((code>=60 && code<=79) || (code>=170 && code<=179) ||
+        (code>=270 && code<=289) || (code>=370 && code<=389) ||
+        (code>=400 && code<=409) || (code>=1060 && code<=1070)) {
+        return DL_BINARY_INT16;
+    }
+    if ((code>=90 && code<=99) || (code>=420 && code<=429) ||
+        (code>=440 && code<=459) || code==1071) {
+        return DL_BINARY_INT32;
+    }
+    if (code>=160 && code<=169) {
+        return DL_BINARY_INT64;
+    }
+    if (code>=290 && code<=299) {
+        return DL_BINARY_BOOL;
+    }
+    if ((code>=310 && code<=319) || code==1004) {
+        return DL_BINARY_CHUNK;
+    }
+    return DL_BINARY_STRING;
+}
+
+/**
+ * Reads a little endian integer of \p size bytes.
+ */
+static unsigned long long getLittleEndian(const unsigned char* p, int size) {
+    unsigned long long v = 0;
+    for (int i=size-1; i>=0; --i) {
+        v = (v<<8) | p[i];
+    }
+    return v;
+}
+
+/**
+ * Writes the decimal representation of \p v to \p s.
+ */
+static void formatInteger(long long v, std::string& s) {
+    char buf[24];
+    char* p = buf + sizeof(buf);
+    unsigned long long u = v<0 ? 0ULL-(unsigned long long)v : (unsigned long long)v;
+    do {
+        *--p = (char)('0' + u%10);
+        u /= 10;
+    } while (u!=0);
+    if (v<0) {
+        *--p = '-';
+    }
+    s.assign(p, buf + sizeof(buf) - p);
+}
+
+/**
+ * Writes a representation of \p v to \p s which is converted back to
+ * the same value by DL_Dxf::toReal().
+ */
+static void formatReal(double v, std::string& s) {
+    if (v>-1.0e15 && v<1.0e15 && v==(double)(long long)v) {
+        formatInteger((long long)v, s);
+        return;
+    }
+    char buf[32];
+    s.assign(buf, DL_WriterA::formatReal(buf, v));
+}
+
+
+
+/**
+ * @brief Reads a group from a binary DXF file. If \p pos points to the
+ * sentinel of the file (see isBinary()), it is skipped.
+ *
+ * Group codes are 2 byte integers (1 byte for R12, 255 being followed by
+ * a 2 byte code). Values are stored in a type depending on the group
+ * code. Numbers are decoded directly, real values are passed on to the
+ * handlers without converting them to text and back.
+ *
+ * Values are passed to processCodeValuePair() and processDXFGroup()
+ * as strings just like for ASCII DXF files. Binary chunks are passed
+ * as hex strings.
+ *
+ * @retval true If the end of the input has not been reached.
+ * @retval false If the end of the input has been reached or the input
+ *      is truncated.
+ */
+bool DL_Dxf::readDxfGroupsBinary(const char*& pos, const char* end,
+                                 DL_CreationInterface* creationInterface) {
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(pos);
+    const unsigned char* e = reinterpret_cast<const unsigned char*>(end);
+
+    if (isBinary(pos, end-pos)) {
+        // R13 and later start with a 2 byte code 0 (SECTION) or 999
+        // (comment), R12 uses 1 byte codes:
+        p += DL_DXF_BINARY_SENTINEL_SIZE;
+        int first = e-p>=2 ? (int)getLittleEndian(p, 2) : -1;
+        binaryCodeSize = (first==0 || first==999) ? 2 : 1;
+    }
+
+    int code;
+    if (binaryCodeSize==1 && e-p>=1 && p[0]!=255) {
+        code = p[0];
+        p += 1;
+    }
+    else {
+        if (binaryCodeSize==1) {
+            ++p;
+        }
+        if (e-p<2) {
+            pos = end;
+            return false;
+        }
+        code = (short)getLittleEndian(p, 2);
+        p += 2;
+    }
+
+    groupRealValid = false;
+    switch (getBinaryType(code)) {
+    case DL_BINARY_REAL: {
+        if (e-p<8) {
+            pos = end;
+            return false;
+        }
+        unsigned long long bits = getLittleEndian(p, 8);
+        memcpy(&groupReal, &bits, sizeof(groupReal));
+        groupRealValid = true;
+        formatReal(groupReal, groupValue);
+        p += 8;
+        break;
+    }
+    case DL_BINARY_INT16:
+    case DL_BINARY_INT32:
+    case DL_BINARY_INT64:
+    case DL_BINARY_BOOL: {
+        int size = 1;
+        switch (getBinaryType(code)) {
+        case DL_BINARY_INT16:
+            size = 2;
+            break;
+        case DL_BINARY_INT32:
+            size = 4;
+            break;
+        case DL_BINARY_INT64:
+            size = 8;
+            break;
+        default:
+            break;
+        }
+        if (e-p<size) {
+            pos = end;
+            return false;
+        }
+        unsigned long long bits = getLittleEndian(p, size);
+        long long v;
+        switch (size) {
+        case 2:
+            v = (short)bits;
+            break;
+        case 4:
+            v = (int)bits;
+            break;
+        case 8:
+            v = (long long)bits;
+            break;
+        default:
+            v = (unsigned char)bits;
+            break;
+        }
+        formatInteger(v, groupValue);
+        p += size;
+        break;
+    }
+    case DL_BINARY_CHUNK: {
+        if (e-p<1 || e-p-1<p[0]) {
+            pos = end;
+            return false;
+        }
+        static const char hex[] = "0123456789ABCDEF";
+        int length = p[0];
+        ++p;
+        groupValue.resize(2*length);
+        for (int i=0; i<length; ++i) {
+            groupValue[2*i] = hex[p[i]>>4];
+            groupValue[2*i+1] = hex[p[i]&0xf];
+        }
+        p += length;
+        break;
+    }
+    default: {
+        const unsigned char* zero =
+            static_cast<const unsigned char*>(memchr(p, '\0', e-p));
+        if (zero==NULL) {
+            pos = end;
+            return false;
+        }
+        groupValue.assign(reinterpret_cast<const char*>(p), zero-p);
+        p = zero+1;
+        break;
+    }
+    }
+
+    groupCode = (unsigned int)code;
+    pos = reinterpret_cast<const char*>(p);
+
+    creationInterface->processCodeValuePair(groupCode, groupValue);
+    line+=2;
+    processDXFGroup(creationInterface, groupCode, groupValue);
+    groupRealValid = false;
+
+    return pos<end;
+}
+
+
+
 /**
  * @brief Strips leading whitespace and trailing Carriage Return (CR)
  * and Line Feed (LF) from NULL terminated string.
@@ -578,7 +1230,7 @@ bool DL_Dxf::processDXFGroup(DL_CreationInterface* creationInterface,
 //        for (int i=0; i<DL_DXF_MAXGROUPCODE; ++i) {
 //            values[i][0] = '\0';
 //        }
-        values.clear();
+        clearValues();
         settingValue[0] = '\0';
         settingKey = "";
         firstHatchLoop = true;
@@ -586,6 +1238,19 @@ bool DL_Dxf::processDXFGroup(DL_CreationInterface* creationInterface,
         hatchEdge = DL_HatchEdgeData();
         //xRecordHandle = "";
         xRecordValues = false;
+        // vertex, knot and control point counts only apply to the entity
+        // which defined them:
+        maxVertices = 0;
+        vertexIndex = 0;
+        maxKnots = 0;
+        knotIndex = 0;
+        maxControlPoints = 0;
+        controlPointIndex = 0;
+        weightIndex = 0;
+        maxFitPoints = 0;
+        fitPointIndex = 0;
+        maxLeaderVertices = 0;
+        leaderVertexIndex = 0;
 
         // Last DXF entity or setting has been handled
         // Now determine what the next entity or setting type is
@@ -695,7 +1360,7 @@ bool DL_Dxf::processDXFGroup(DL_CreationInterface* creationInterface,
         // Group code does not indicate start of new entity or setting,
         // so this group must be continuation of data for the current
         // one.
-        if (groupCode<DL_DXF_MAXGROUPCODE) {
+        if (groupCode>=0 && groupCode<DL_DXF_MAXGROUPCODE) {
 
             bool handled = false;
 
@@ -743,7 +1408,7 @@ bool DL_Dxf::processDXFGroup(DL_CreationInterface* creationInterface,
 
             if (!handled) {
                 // Normal group / value pair:
-                values[groupCode] = groupValue;
+                setValue(groupCode, groupValue);
             }
         }
 
@@ -775,11 +1440,7 @@ void DL_Dxf::addDictionaryEntry(DL_CreationInterface* creationInterface) {
  * Adds a variable from the DXF file.
  */
 void DL_Dxf::addSetting(DL_CreationInterface* creationInterface) {
-    int c = -1;
-    std::map<int,std::string>::iterator it = values.begin();
-    if (it!=values.end()) {
-        c = it->first;
-    }
+    int c = firstValueCode;
 //    for (int i=0; i<=380; ++i) {
 //        if (values[i][0]!='\0') {
 //            c = i;
@@ -2308,15 +2969,18 @@ void DL_Dxf::endSequence(DL_CreationInterface* creationInterface) {
  * writing functions.
  *
  * @param file Full path of the file to open.
+ * @param bufferSize Output buffer size, 0 for unbuffered output
+ *      (see DL_WriterA).
  *
  * @return Pointer to an ascii dxf writer object.
  */
-DL_WriterA* DL_Dxf::out(const char* file, DL_Codes::version version) {
+DL_WriterA* DL_Dxf::out(const char* file, DL_Codes::version version,
+                        size_t bufferSize) {
     char* f = new char[strlen(file)+1];
     strcpy(f, file);
     this->version = version;
 
-    DL_WriterA* dw = new DL_WriterA(f, version);
+    DL_WriterA* dw = new DL_WriterA(f, version, bufferSize);
     if (dw->openFailed()) {
         delete dw;
         delete[] f;
@@ -5276,6 +5940,156 @@ int DL_Dxf::getLibVersion(const std::string& str) {
     }
 }
 
+/**
+ * @brief Converts the given string into a double.
+ *
+ * Accepts the same input as reading a double from a stream in the "C"
+ * locale: leading whitespace, an optional sign, digits with an optional
+ * decimal point and an optional exponent. A comma is accepted as
+ * decimal point (written by some applications in german locale).
+ * The result is independent of the current global or C locale.
+ *
+ * Values with up to 15 significant digits and a small exponent are
+ * converted exactly with a single floating point operation, all other
+ * values are passed to strtod in the "C" locale. Both yield the
+ * correctly rounded double.
+ *
+ * @param str Characters to convert, need not be NULL terminated.
+ * @param length Number of characters in \p str.
+ *
+ * @return The converted value or 0.0 if \p str does not start with a
+ *      number.
+ */
+double DL_Dxf::toReal(const char* str, size_t length) {
+    // Exactly representable powers of ten:
+    static const double powersOfTen[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* p = str;
+    const char* end = str + length;
+
+    // Skip leading whitespace:
+    while (p<end && (*p==' ' || *p=='\t' || *p=='\n' ||
+                     *p=='\r' || *p=='\v' || *p=='\f')) {
+        ++p;
+    }
+    const char* first = p;
+
+    bool negative = false;
+    if (p<end && (*p=='-' || *p=='+')) {
+        negative = (*p=='-');
+        ++p;
+    }
+
+    // Accumulate up to 19 significant digits:
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool truncated = false;
+
+    for (; p<end && *p>='0' && *p<='9'; ++p) {
+        hasDigits = true;
+        if (digits<19) {
+            mantissa = mantissa*10 + (*p-'0');
+            if (mantissa!=0) {
+                ++digits;
+            }
+        }
+        else {
+            ++exponent;
+            truncated = truncated || *p!='0';
+        }
+    }
+
+    if (p<end && (*p=='.' || *p==',')) {
+        ++p;
+        for (; p<end && *p>='0' && *p<='9'; ++p) {
+            hasDigits = true;
+            if (digits<19) {
+                mantissa = mantissa*10 + (*p-'0');
+                if (mantissa!=0) {
+                    ++digits;
+                }
+                --exponent;
+            }
+            else {
+                truncated = truncated || *p!='0';
+            }
+        }
+    }
+
+    if (!hasDigits) {
+        return 0.0;
+    }
+
+    // Exponent, only if followed by at least one digit:
+    if (p<end && (*p=='e' || *p=='E')) {
+        const char* e = p+1;
+        bool negativeExponent = false;
+        if (e<end && (*e=='-' || *e=='+')) {
+            negativeExponent = (*e=='-');
+            ++e;
+        }
+        if (e<end && *e>='0' && *e<='9') {
+            int exp = 0;
+            for (; e<end && *e>='0' && *e<='9'; ++e) {
+                if (exp<100000) {
+                    exp = exp*10 + (*e-'0');
+                }
+            }
+            exponent += negativeExponent ? -exp : exp;
+            p = e;
+        }
+    }
+
+    // Fast path: mantissa and power of ten are both exact doubles, so
+    // the single multiplication or division is correctly rounded.
+    // Not used with x87 extended precision (double rounding).
+#if !(defined(__i386__) && !defined(__SSE2_MATH__)) && !(defined(_M_IX86) && !defined(_M_IX86_FP))
+    if (!truncated && mantissa<=(1ULL<<53) &&
+        exponent>=-22 && exponent<=22) {
+
+        double value = (double)mantissa;
+        if (exponent<0) {
+            value /= powersOfTen[-exponent];
+        }
+        else {
+            value *= powersOfTen[exponent];
+        }
+        return negative ? -value : value;
+    }
+#endif
+
+    // Slow path: strtod in the "C" locale on a copy of the number with
+    // '.' as decimal point:
+    std::string number(first, p);
+    std::replace(number.begin(), number.end(), ',', '.');
+
+    char* numberEnd;
+#ifdef _WIN32
+    static const _locale_t cLocale = _create_locale(LC_NUMERIC, "C");
+    double value = _strtod_l(number.c_str(), &numberEnd, cLocale);
+#else
+    static const locale_t cLocale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    double value = strtod_l(number.c_str(), &numberEnd, cLocale);
+#endif
+
+    // Out of range, same as std::istream:
+    if (value==HUGE_VAL) {
+        return DBL_MAX;
+    }
+    if (value==-HUGE_VAL) {
+        return -DBL_MAX;
+    }
+    return value;
+}
+
+
+
 /**
  * Converts the given string into a double or returns the given
  * default valud (def) if value is NULL or empty.
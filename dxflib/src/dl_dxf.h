@@ -33,6 +33,8 @@
 #include <string>
 #include <sstream>
 #include <map>
+#include <vector>
+#include <algorithm>
 
 #include "dl_attributes.h"
 #include "dl_codes.h"
@@ -138,6 +140,22 @@ public:
     static bool getStrippedLine(std::string& s, unsigned int size,
                                std::istream& stream, bool stripSpace = true);
 
+    bool inMapped(const std::string& file,
+                  DL_CreationInterface* creationInterface);
+    bool readDxfGroups(const char*& pos, const char* end,
+                       DL_CreationInterface* creationInterface);
+    static bool getStrippedLine(const char*& line, size_t& length,
+                                const char*& pos, const char* end,
+                                bool stripSpace = true);
+
+    bool inParallel(const std::string& file,
+                    DL_CreationInterface* creationInterface,
+                    int numThreads = 0);
+
+    static bool isBinary(const char* data, size_t size);
+    bool readDxfGroupsBinary(const char*& pos, const char* end,
+                             DL_CreationInterface* creationInterface);
+
     static bool stripWhiteSpace(char** s, bool stripSpaces = true);
 
     bool processDXFGroup(DL_CreationInterface* creationInterface,
@@ -215,7 +233,8 @@ public:
     //int  stringToInt(const char* s, bool* ok=NULL);
 
     DL_WriterA* out(const char* file,
-                    DL_Codes::version version=DL_VERSION_2000);
+                    DL_Codes::version version=DL_VERSION_2000,
+                    size_t bufferSize=0);
 
     void writeHeader(DL_WriterA& dw);
 
@@ -407,7 +426,8 @@ public:
     static void test();
 
     bool hasValue(int code) {
-        return values.count(code)==1;
+        return code>=0 && code<DL_DXF_MAXGROUPCODE &&
+               valueStamps[code]==valueGeneration;
     }
 
     int getIntValue(int code, int def) {
@@ -450,22 +470,54 @@ public:
         if (!hasValue(code)) {
             return def;
         }
-        return toReal(values[code]);
+        // convert every value only once per entity:
+        if (realStamps[code]!=valueGeneration) {
+            realValues[code] = toReal(values[code]);
+            realStamps[code] = valueGeneration;
+        }
+        return realValues[code];
     }
 
     double toReal(const std::string& str) {
-        double ret;
-        // make sure the real value uses '.' not ',':
-        std::string str2 = str;
-        std::replace(str2.begin(), str2.end(), ',', '.');
-        // make sure c++ expects '.' not ',':
-        std::istringstream istr(str2);
-        //istr.imbue(std::locale("C"));
-        istr >> ret;
-        return ret;
+        // values read from binary DXF are not parsed again:
+        if (groupRealValid && &str==&groupValue) {
+            return groupReal;
+        }
+        return toReal(str.c_str(), str.length());
     }
 
+    static double toReal(const char* str, size_t length);
+
 private:
+    void setValue(int code, const std::string& value) {
+        if (code<0 || code>=DL_DXF_MAXGROUPCODE) {
+            return;
+        }
+        values[code] = value;
+        valueStamps[code] = valueGeneration;
+        if (groupRealValid && &value==&groupValue) {
+            realValues[code] = groupReal;
+            realStamps[code] = valueGeneration;
+        }
+        else {
+            realStamps[code] = 0;
+        }
+        if (firstValueCode<0 || code<firstValueCode) {
+            firstValueCode = code;
+        }
+    }
+
+    void clearValues() {
+        ++valueGeneration;
+        if (valueGeneration==0) {
+            // stamps wrapped around, invalidate all slots explicitly:
+            std::fill(valueStamps.begin(), valueStamps.end(), 0);
+            std::fill(realStamps.begin(), realStamps.end(), 0);
+            valueGeneration = 1;
+        }
+        firstValueCode = -1;
+    }
+
     DL_Codes::version version;
 
     std::string polylineLayer;
@@ -505,14 +557,31 @@ private:
     unsigned int groupCode;
     // Only the useful part of the group value
     std::string groupValue;
+    // Value of the current group as read from binary DXF, valid only
+    //  while the group is processed and only for real values
+    double groupReal;
+    bool groupRealValid;
+    // Size of group codes in binary DXF: 2 bytes or 1 byte (R12)
+    int binaryCodeSize;
+    // Line number of the next group code in the file being read
+    int line;
     // Current entity type
     int currentObjectType;
     // Value of the current setting
     char settingValue[DL_DXF_MAXLINE+1];
     // Key of the current setting (e.g. "$ACADVER")
     std::string settingKey;
-    // Stores the group codes
-    std::map<int, std::string> values;
+    // Stores the group values of the current entity, indexed by group
+    //  code. A slot is only valid if its stamp matches valueGeneration,
+    //  so all values are cleared by incrementing the generation.
+    std::vector<std::string> values;
+    std::vector<unsigned int> valueStamps;
+    // Group values converted to double, valid if the stamp matches:
+    std::vector<double> realValues;
+    std::vector<unsigned int> realStamps;
+    unsigned int valueGeneration;
+    // Lowest group code stored for the current entity or setting
+    int firstValueCode;
     // First call of this method. We initialize all group values in
     //  the first call.
     bool firstCall;
@@ -0,0 +1,168 @@
+/****************************************************************************
+** Copyright (C) 2001-2013 RibbonSoft, GmbH. All rights reserved.
+**
+** This file is part of the dxflib project.
+**
+** This file is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** Licensees holding valid dxflib Professional Edition licenses may use
+** this file in accordance with the dxflib Commercial License
+** Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.ribbonsoft.com for further details.
+**
+** Contact info@ribbonsoft.com if any conditions of this licensing are
+** not clear to you.
+**
+**********************************************************************/
+
+#include "dl_mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+/**
+ * Default constructor. No file is mapped.
+ */
+DL_MappedFile::DL_MappedFile() :
+    m_data(NULL),
+    m_size(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE),
+    m_mapping(NULL)
+#else
+    , m_fd(-1)
+#endif
+{
+}
+
+
+
+/**
+ * Destructor. Unmaps the file.
+ */
+DL_MappedFile::~DL_MappedFile() {
+    close();
+}
+
+
+
+/**
+ * @brief Maps the given file read only into memory.
+ *
+ * @param file Path and name of file to map.
+ *
+ * @retval true If \p file could be opened. An empty file is opened
+ *      successfully but data() returns NULL.
+ * @retval false If \p file could not be opened or mapped.
+ */
+bool DL_MappedFile::open(const std::string& file) {
+    close();
+
+#ifdef _WIN32
+    HANDLE f = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                           NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (f==INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    m_file = f;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(f, &size)) {
+        close();
+        return false;
+    }
+    if (size.QuadPart==0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping==NULL) {
+        close();
+        return false;
+    }
+    m_mapping = mapping;
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view==NULL) {
+        close();
+        return false;
+    }
+    m_data = static_cast<const char*>(view);
+    m_size = (size_t)size.QuadPart;
+#else
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd<0) {
+        return false;
+    }
+    m_fd = fd;
+
+    struct stat st;
+    if (fstat(fd, &st)!=0) {
+        close();
+        return false;
+    }
+    if (st.st_size==0) {
+        return true;
+    }
+
+    void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view==MAP_FAILED) {
+        close();
+        return false;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+    m_data = static_cast<const char*>(view);
+    m_size = (size_t)st.st_size;
+#endif
+
+    return true;
+}
+
+
+
+/**
+ * Unmaps the file and closes all handles.
+ */
+void DL_MappedFile::close() {
+#ifdef _WIN32
+    if (m_data!=NULL) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping!=NULL) {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    if (m_file!=INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_data!=NULL) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+    if (m_fd>=0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_data = NULL;
+    m_size = 0;
+}
+
+// EOF
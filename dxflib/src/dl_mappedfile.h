@@ -0,0 +1,82 @@
+/****************************************************************************
+** Copyright (C) 2001-2013 RibbonSoft, GmbH. All rights reserved.
+**
+** This file is part of the dxflib project.
+**
+** This file is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** Licensees holding valid dxflib Professional Edition licenses may use
+** this file in accordance with the dxflib Commercial License
+** Agreement provided with the Software.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.ribbonsoft.com for further details.
+**
+** Contact info@ribbonsoft.com if any conditions of this licensing are
+** not clear to you.
+**
+**********************************************************************/
+
+#ifndef DL_MAPPEDFILE_H
+#define DL_MAPPEDFILE_H
+
+#include "dl_global.h"
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <stddef.h>
+#include <string>
+
+/**
+ * Read only memory mapping of a whole file.
+ *
+ * Used by DL_Dxf::inMapped() to tokenize DXF group couplets directly
+ * over the file contents without reading them line by line.
+ */
+class DXFLIB_EXPORT DL_MappedFile {
+public:
+    DL_MappedFile();
+    ~DL_MappedFile();
+
+    bool open(const std::string& file);
+    void close();
+
+    /**
+     * @return Pointer to the first byte of the file or NULL if the
+     *      file is empty or not open.
+     */
+    const char* data() const {
+        return m_data;
+    }
+
+    /**
+     * @return Size of the mapped file in bytes.
+     */
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    DL_MappedFile(const DL_MappedFile&);
+    DL_MappedFile& operator=(const DL_MappedFile&);
+
+    const char* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_fd;
+#endif
+};
+
+#endif
+
+// EOF
@@ -31,13 +31,23 @@
 #include <string.h>
 
 #include "dl_writer_ascii.h"
+#include "dl_dxf.h"
 #include "dl_exception.h"
 
 
+/**
+ * Destructor. Writes buffered output to the file.
+ */
+DL_WriterA::~DL_WriterA() {
+    flushBuffer();
+}
+
+
 /**
  * Closes the output file.
  */
 void DL_WriterA::close() const {
+    flushBuffer();
     m_ofile.close();
 }
 
@@ -60,6 +70,11 @@ bool DL_WriterA::openFailed() const {
  */
 void DL_WriterA::dxfReal(int gc, double value) const {
     char str[256];
+    if (m_bufferSize>0 && version!=DL_Codes::AC1009_MIN) {
+        writeGroup(gc, str, formatReal(str, value));
+        return;
+    }
+
     if (version==DL_Codes::AC1009_MIN) {
         sprintf(str, "%.6lf", value);
     }
@@ -87,7 +102,97 @@ void DL_WriterA::dxfReal(int gc, double value) const {
     }
 
     dxfString(gc, str);
-    m_ofile.flush();
+    if (m_bufferSize==0) {
+        m_ofile.flush();
+    }
+}
+
+
+
+/**
+ * @brief Writes \p value in the shortest form that DL_Dxf::toReal()
+ * converts back to the identical double. Integral values get a ".0"
+ * suffix.
+ *
+ * Values with up to 15 decimals and a mantissa below 2^53 (practically
+ * all coordinates in drawings) are formatted without sprintf. Others
+ * are formatted with the lowest of 15, 16 or 17 significant digits
+ * which reads back correctly.
+ *
+ * @param str Output, at least 32 characters. Not NULL terminated.
+ * @param value Value to format.
+ *
+ * @return Number of characters written to \p str.
+ */
+int DL_WriterA::formatReal(char* str, double value) {
+    char buf[32];
+    char* p = buf + sizeof(buf);
+    double a = value<0.0 ? -value : value;
+
+    if (a<1.0e15 && a==(double)(long long)a) {
+        long long m = (long long)a;
+        *--p = '0';
+        *--p = '.';
+        do {
+            *--p = (char)('0' + m%10);
+            m /= 10;
+        } while (m!=0);
+        if (value<0.0) {
+            *--p = '-';
+        }
+        memcpy(str, p, buf + sizeof(buf) - p);
+        return (int)(buf + sizeof(buf) - p);
+    }
+
+    // Shortest m/10^k (m < 2^53) which divides back to the value. The
+    // division is correctly rounded, so the decimal m*10^-k is read
+    // back as the same value. Not used with x87 extended precision
+    // (double rounding).
+#if !(defined(__i386__) && !defined(__SSE2_MATH__)) && !(defined(_M_IX86) && !defined(_M_IX86_FP))
+    static const double powersOfTen[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
+    for (int k=1; k<=15; ++k) {
+        double scaled = a*powersOfTen[k];
+        if (!(scaled<9007199254740992.0)) {
+            break;
+        }
+        long long m = (long long)(scaled+0.5);
+        if ((double)m/powersOfTen[k]!=a) {
+            continue;
+        }
+        for (int i=0; i<k; ++i) {
+            *--p = (char)('0' + m%10);
+            m /= 10;
+        }
+        *--p = '.';
+        do {
+            *--p = (char)('0' + m%10);
+            m /= 10;
+        } while (m!=0);
+        if (value<0.0) {
+            *--p = '-';
+        }
+        memcpy(str, p, buf + sizeof(buf) - p);
+        return (int)(buf + sizeof(buf) - p);
+    }
+#endif
+
+    int length = 0;
+    for (int precision=15; precision<=17; ++precision) {
+        length = snprintf(str, 32, "%.*g", precision, value);
+        // fix for german locale:
+        for (int i=0; i<length; ++i) {
+            if (str[i]==',') {
+                str[i] = '.';
+            }
+        }
+        if (DL_Dxf::toReal(str, length)==value) {
+            break;
+        }
+    }
+    return length;
 }
 
 
@@ -99,7 +204,22 @@ void DL_WriterA::dxfReal(int gc, double value) const {
  * @param value Int value
  */
 void DL_WriterA::dxfInt(int gc, int value) const {
-    m_ofile << (gc<10 ? "  " : (gc<100 ? " " : "")) << gc << "\n" << value << "\n";
+    if (m_bufferSize==0) {
+        m_ofile << (gc<10 ? "  " : (gc<100 ? " " : "")) << gc << "\n" << value << "\n";
+        return;
+    }
+
+    char str[12];
+    char* p = str + sizeof(str);
+    unsigned int u = value<0 ? 0U-(unsigned int)value : (unsigned int)value;
+    do {
+        *--p = (char)('0' + u%10);
+        u /= 10;
+    } while (u!=0);
+    if (value<0) {
+        *--p = '-';
+    }
+    writeGroup(gc, p, str + sizeof(str) - p);
 }
 
 
@@ -130,15 +250,69 @@ void DL_WriterA::dxfString(int gc, const char* value) const {
         //throw DL_NullStrExc();
 #endif
     }
-    m_ofile << (gc<10 ? "  " : (gc<100 ? " " : "")) << gc << "\n"
-    << value << "\n";
+    if (m_bufferSize==0) {
+        m_ofile << (gc<10 ? "  " : (gc<100 ? " " : "")) << gc << "\n"
+        << value << "\n";
+        return;
+    }
+    writeGroup(gc, value, value==NULL ? 0 : strlen(value));
 }
 
 
 
 void DL_WriterA::dxfString(int gc, const std::string& value) const {
-    m_ofile << (gc<10 ? "  " : (gc<100 ? " " : "")) << gc << "\n"
-    << value << "\n";
+    if (m_bufferSize==0) {
+        m_ofile << (gc<10 ? "  " : (gc<100 ? " " : "")) << gc << "\n"
+        << value << "\n";
+        return;
+    }
+    writeGroup(gc, value.data(), value.length());
+}
+
+
+
+/**
+ * Appends a group (code and value) to the output buffer and writes the
+ * buffer to the file when it is full. Buffered mode only.
+ */
+void DL_WriterA::writeGroup(int gc, const char* value, size_t length) const {
+    char str[16];
+    char* p = str + sizeof(str);
+    *--p = '\n';
+    unsigned int u = gc<0 ? 0U-(unsigned int)gc : (unsigned int)gc;
+    do {
+        *--p = (char)('0' + u%10);
+        u /= 10;
+    } while (u!=0);
+    if (gc<0) {
+        *--p = '-';
+    }
+    // right align codes below 100 like the stream output:
+    if (gc<100) {
+        *--p = ' ';
+    }
+    if (gc<10) {
+        *--p = ' ';
+    }
+    m_buffer.append(p, str + sizeof(str) - p);
+    m_buffer.append(value, length);
+    m_buffer.push_back('\n');
+
+    if (m_buffer.size()>=m_bufferSize) {
+        flushBuffer();
+    }
+}
+
+
+
+/**
+ * Writes the output buffer to the file.
+ */
+void DL_WriterA::flushBuffer() const {
+    if (!m_buffer.empty()) {
+        m_ofile.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
 }
 
 
@@ -42,15 +42,24 @@
  * 
  * @para fname File name of the file to be created.
  * @para version DXF version. Defaults to DL_VERSION_2002.
+ * @para bufferSize Size of the output buffer in bytes. With 0 (default)
+ *   every value is passed on to the stream directly and the file is
+ *   flushed after every real value. Otherwise values are collected in
+ *   the buffer which is written when it is full or on close(), and reals
+ *   are written in the shortest form that reads back to the same value
+ *   (see formatReal()).
  *
  * @todo What if \c fname is NULL?  Or \c fname can't be opened for
  * another reason?
  */
 class DXFLIB_EXPORT DL_WriterA : public DL_Writer {
 public:
-    DL_WriterA(const char* fname, DL_Codes::version version=DL_VERSION_2000)
-            : DL_Writer(version), m_ofile(fname) {}
-    virtual ~DL_WriterA() {}
+    DL_WriterA(const char* fname, DL_Codes::version version=DL_VERSION_2000,
+               size_t bufferSize=0)
+            : DL_Writer(version), m_ofile(fname), m_bufferSize(bufferSize) {
+        m_buffer.reserve(bufferSize);
+    }
+    virtual ~DL_WriterA();
 
     bool openFailed() const;
     void close() const;
@@ -61,13 +70,23 @@ public:
     void dxfString(int gc, const std::string& value) const;
 
     static void strReplace(char* str, char src, char dest);
+    static int formatReal(char* str, double value);
 
 private:
+    void writeGroup(int gc, const char* value, size_t length) const;
+    void flushBuffer() const;
+
     /**
      * DXF file to be created.
      */
     mutable std::ofstream m_ofile;
 
+    /**
+     * Output not yet written to m_ofile (buffered mode only).
+     */
+    mutable std::string m_buffer;
+    size_t m_bufferSize;
+
 };
 
 #endif
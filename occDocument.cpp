@@ -0,0 +1,366 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : occDocument.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Scene document of the shapes in the viewer.
+*/
+
+#include "occDocument.h"
+
+#include <QVariant>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <Precision.hxx>
+
+#include <TopoDS_Iterator.hxx>
+#include <TopExp_Explorer.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <TopoDS.hxx>
+#include <Poly_Triangulation.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <StdPrs_ToolTriangulatedShape.hxx>
+
+#include <stlReader.h>
+
+// presentation being meshed by a watcher, and the deflections it is meshed with.
+static const char* THE_PRESENTATION_PROPERTY = "presentation";
+static const char* THE_DEFLECTION_PROPERTY = "deflection";
+static const char* THE_ANGLE_PROPERTY = "angle";
+
+// BRepMesh takes about a millisecond for a trimmed BSpline face of a
+// typical STEP part, so from about 200 faces the shaded display of an
+// import would block the GUI for a noticeable 0.2 s or more.
+static const int THE_MIN_BACKGROUND_FACES = 200;
+
+occDocument::occDocument(const Handle(AIS_InteractiveContext)& theContext, QObject *parent) : QObject(parent),
+    myContext(theContext),
+    myBatchDepth(0),
+    myMinBackgroundFaces(THE_MIN_BACKGROUND_FACES)
+{
+}
+
+occDocument::~occDocument()
+{
+    waitForMeshing();
+}
+
+int occDocument::add(const Handle(AIS_Shape)& thePresentation, const QString& theName, bool toUpdate)
+{
+    occDocumentEntry anEntry;
+    anEntry.Name = theName;
+    anEntry.Shape = thePresentation->Shape();
+    anEntry.Presentation = thePresentation;
+
+    // a batch updates the viewer once at its end.
+    toUpdate = toUpdate && myBatchDepth == 0;
+
+    // without edges the wireframe would show nothing.
+    anEntry.IsMeshOnly = StlReader::IsMeshOnly(anEntry.Shape);
+    if (anEntry.IsMeshOnly)
+    {
+        thePresentation->SetDisplayMode(AIS_Shaded);
+        return display(anEntry, toUpdate);
+    }
+
+    int aNbFaces = 0;
+    if (myMinBackgroundFaces > 0)
+    {
+        for (TopExp_Explorer anExp(anEntry.Shape, TopAbs_FACE); anExp.More() && aNbFaces < myMinBackgroundFaces; anExp.Next())
+        {
+            ++aNbFaces;
+        }
+    }
+
+    if (myMinBackgroundFaces <= 0 || aNbFaces < myMinBackgroundFaces)
+    {
+        return display(anEntry, toUpdate);
+    }
+
+    // the box is taken before the worker writes the triangulation.
+    BRepBndLib::Add(anEntry.Shape, anEntry.Box, Standard_False);
+    anEntry.IsBoxValid = true;
+    if (anEntry.Box.IsVoid())
+    {
+        return display(anEntry, toUpdate);
+    }
+
+    // the same deflection as the shaded presentation, so Display does not mesh again.
+    const Handle(Prs3d_Drawer)& aDrawer = thePresentation->Attributes();
+    const double aDeflection = StdPrs_ToolTriangulatedShape::GetDeflection(anEntry.Shape, aDrawer);
+    const double anAngle = aDrawer->HLRAngle();
+
+    Standard_Real aXmin, aYmin, aZmin, aXmax, aYmax, aZmax;
+    anEntry.Box.Get(aXmin, aYmin, aZmin, aXmax, aYmax, aZmax);
+    const double aGap = Precision::Confusion();
+    BRepPrimAPI_MakeBox aBox(gp_Pnt(aXmin, aYmin, aZmin),
+        gp_Pnt(qMax(aXmax, aXmin + aGap), qMax(aYmax, aYmin + aGap), qMax(aZmax, aZmin + aGap)));
+
+    // the worker meshes a copy of its own, the faces of the shape may be
+    // shared with other entries that the GUI thread displays or meshes,
+    // e.g. the operands of a boolean and its result. The geometry is
+    // shared, only the topology is copied. A triangulation the faces already
+    // have, e.g. from the cache, is kept so it is not made again.
+    BRepBuilderAPI_Copy aCopy(anEntry.Shape, Standard_False);
+    BRep_Builder aBuilder;
+    for (TopExp_Explorer anExp(anEntry.Shape, TopAbs_FACE); anExp.More(); anExp.Next())
+    {
+        TopLoc_Location aLoc;
+        const TopoDS_Face& aFace = TopoDS::Face(anExp.Current());
+        const Handle(Poly_Triangulation)& aTriangulation = BRep_Tool::Triangulation(aFace, aLoc);
+        if (!aTriangulation.IsNull() && aCopy.IsModified(aFace))
+        {
+            aBuilder.UpdateFace(TopoDS::Face(aCopy.Modified(aFace).First()), aTriangulation);
+        }
+    }
+    anEntry.Shape = aCopy.Shape();
+    thePresentation->Set(anEntry.Shape);
+
+    anEntry.IsMeshing = true;
+    anEntry.Placeholder = new AIS_Shape(aBox.Shape());
+    anEntry.Placeholder->SetColor(Quantity_NOC_GRAY);
+    myContext->Display(anEntry.Placeholder, AIS_WireFrame, -1, toUpdate ? Standard_True : Standard_False);
+
+    myEntries.push_back(anEntry);
+
+    // the sub-shapes are meshed one after another, each on all cores, to
+    // report the progress.
+    const TopoDS_Shape aShape = anEntry.Shape;
+    QFutureWatcher<void>* aWatcher = new QFutureWatcher<void>(this);
+    aWatcher->setProperty(THE_PRESENTATION_PROPERTY, QVariant::fromValue((void*)thePresentation.get()));
+    aWatcher->setProperty(THE_DEFLECTION_PROPERTY, aDeflection);
+    aWatcher->setProperty(THE_ANGLE_PROPERTY, anAngle);
+    connect(aWatcher, SIGNAL(finished()), this, SLOT(onMeshFinished()));
+    myMeshJobs.append(aWatcher);
+
+    emit meshProgress(theName, 0);
+    aWatcher->setFuture(QtConcurrent::run([this, theName, aShape, aDeflection, anAngle]()
+    {
+        int aNbParts = 0;
+        for (TopoDS_Iterator anIter(aShape); anIter.More(); anIter.Next())
+        {
+            ++aNbParts;
+        }
+
+        if (aShape.ShapeType() != TopAbs_COMPOUND || aNbParts < 2)
+        {
+            BRepMesh_IncrementalMesh aMesher(aShape, aDeflection, Standard_False, anAngle, Standard_True);
+            return;
+        }
+
+        int aDone = 0;
+        for (TopoDS_Iterator anIter(aShape); anIter.More(); anIter.Next())
+        {
+            BRepMesh_IncrementalMesh aMesher(anIter.Value(), aDeflection, Standard_False, anAngle, Standard_True);
+            emit meshProgress(theName, 99 * ++aDone / aNbParts);
+        }
+    }));
+
+    return (int)myEntries.size() - 1;
+}
+
+int occDocument::display(const occDocumentEntry& theEntry, bool toUpdate)
+{
+    myEntries.push_back(theEntry);
+    myContext->Display(theEntry.Presentation, toUpdate ? Standard_True : Standard_False);
+
+    const int anIndex = (int)myEntries.size() - 1;
+    emit meshChanged(anIndex);
+    return anIndex;
+}
+
+void occDocument::beginBatch(void)
+{
+    ++myBatchDepth;
+}
+
+void occDocument::commitBatch(bool toUpdate)
+{
+    if (myBatchDepth == 0)
+    {
+        return;
+    }
+
+    if (--myBatchDepth == 0 && toUpdate)
+    {
+        myContext->UpdateCurrentViewer();
+    }
+}
+
+void occDocument::setBackgroundMeshing(int theMinFaces)
+{
+    myMinBackgroundFaces = theMinFaces;
+}
+
+void occDocument::waitForMeshing(void)
+{
+    while (!myMeshJobs.isEmpty())
+    {
+        QFutureWatcher<void>* aWatcher = myMeshJobs.first();
+        aWatcher->waitForFinished();
+
+        // finished() may not be delivered before the watcher is deleted.
+        aWatcher->disconnect(this);
+        finishMesh(aWatcher);
+    }
+}
+
+void occDocument::onMeshFinished(void)
+{
+    QFutureWatcher<void>* aWatcher = dynamic_cast<QFutureWatcher<void>*>(sender());
+    if (aWatcher != nullptr && myMeshJobs.contains(aWatcher))
+    {
+        finishMesh(aWatcher);
+    }
+}
+
+void occDocument::finishMesh(QFutureWatcher<void>* theWatcher)
+{
+    myMeshJobs.removeOne(theWatcher);
+    theWatcher->deleteLater();
+
+    // the entry may have been removed while it was meshed.
+    const void* aPresentation = theWatcher->property(THE_PRESENTATION_PROPERTY).value<void*>();
+    for (size_t i = 0; i < myEntries.size(); ++i)
+    {
+        occDocumentEntry& anEntry = myEntries[i];
+        if (anEntry.Presentation.get() != aPresentation || !anEntry.IsMeshing)
+        {
+            continue;
+        }
+
+        anEntry.IsMeshing = false;
+        anEntry.MeshDeflection = theWatcher->property(THE_DEFLECTION_PROPERTY).toDouble();
+        anEntry.MeshAngle = theWatcher->property(THE_ANGLE_PROPERTY).toDouble();
+        myContext->Remove(anEntry.Placeholder, Standard_False);
+        anEntry.Placeholder.Nullify();
+        myContext->Display(anEntry.Presentation, Standard_True);
+
+        emit meshProgress(anEntry.Name, 100);
+        emit meshChanged((int)i);
+        break;
+    }
+}
+
+int occDocument::nbEntries(void) const
+{
+    return (int)myEntries.size();
+}
+
+const occDocumentEntry& occDocument::entry(int theIndex) const
+{
+    return myEntries[theIndex];
+}
+
+int occDocument::find(const Handle(AIS_InteractiveObject)& thePresentation) const
+{
+    for (size_t i = 0; i < myEntries.size(); ++i)
+    {
+        if (myEntries[i].Presentation == thePresentation ||
+            (!myEntries[i].Placeholder.IsNull() && myEntries[i].Placeholder == thePresentation))
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool occDocument::isVisible(int theIndex) const
+{
+    const occDocumentEntry& anEntry = myEntries[theIndex];
+    return anEntry.IsMeshing || myContext->IsDisplayed(anEntry.Presentation) == Standard_True;
+}
+
+const Bnd_Box& occDocument::boundingBox(int theIndex)
+{
+    occDocumentEntry& anEntry = myEntries[theIndex];
+    if (!anEntry.IsBoxValid)
+    {
+        anEntry.Box.SetVoid();
+        BRepBndLib::Add(anEntry.Shape, anEntry.Box);
+        anEntry.IsBoxValid = true;
+    }
+    return anEntry.Box;
+}
+
+void occDocument::mesh(int theIndex, double theDeflection, double theAngle)
+{
+    // the worker must be done with the faces first.
+    if (myEntries[theIndex].IsMeshing)
+    {
+        waitForMeshing();
+    }
+
+    occDocumentEntry& anEntry = myEntries[theIndex];
+
+    // the triangulation is all there is.
+    if (anEntry.IsMeshOnly)
+    {
+        return;
+    }
+
+    if (theDeflection <= 0.0)
+    {
+        const Bnd_Box& aBox = boundingBox(theIndex);
+        if (aBox.IsVoid())
+        {
+            return;
+        }
+        theDeflection = 0.001 * sqrt(aBox.SquareExtent());
+    }
+
+    // the triangulation of an earlier export is reused if it is fine enough.
+    if (anEntry.MeshDeflection > 0.0 && anEntry.MeshDeflection <= theDeflection && anEntry.MeshAngle <= theAngle)
+    {
+        return;
+    }
+
+    BRepMesh_IncrementalMesh aMesher(anEntry.Shape, theDeflection, Standard_False, theAngle, Standard_True);
+
+    anEntry.MeshDeflection = theDeflection;
+    anEntry.MeshAngle = theAngle;
+
+    emit meshChanged(theIndex);
+}
+
+void occDocument::removeSelected(void)
+{
+    std::vector<Handle(AIS_InteractiveObject)> aSelected;
+    for (myContext->InitSelected(); myContext->MoreSelected(); myContext->NextSelected())
+    {
+        aSelected.push_back(myContext->SelectedInteractive());
+    }
+
+    myContext->ClearSelected(Standard_False);
+
+    for (size_t i = 0; i < aSelected.size(); ++i)
+    {
+        const int anIndex = find(aSelected[i]);
+        if (anIndex < 0)
+        {
+            // dimensions and other helpers are only erased.
+            myContext->Erase(aSelected[i], Standard_False);
+            continue;
+        }
+
+        // an entry still being meshed goes with its placeholder, the worker
+        // finds no entry when it is done.
+        const occDocumentEntry& anEntry = myEntries[anIndex];
+        myContext->Remove(anEntry.Presentation, Standard_False);
+        if (!anEntry.Placeholder.IsNull())
+        {
+            myContext->Remove(anEntry.Placeholder, Standard_False);
+        }
+        myEntries.erase(myEntries.begin() + anIndex);
+    }
+
+    myContext->UpdateCurrentViewer();
+}
+
@@ -0,0 +1,149 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : occDocument.h
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Scene document of the shapes in the viewer.
+*/
+
+#ifndef OCCDOCUMENT_H
+#define OCCDOCUMENT_H
+
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QFutureWatcher>
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+#include <TopoDS_Shape.hxx>
+#include <Bnd_Box.hxx>
+
+//! one object of the scene.
+struct occDocumentEntry
+{
+    occDocumentEntry(void) : IsBoxValid(false), MeshDeflection(0.0), MeshAngle(0.0), IsMeshOnly(false), IsMeshing(false) {}
+
+    //! name shown to the user, the file name for imports.
+    QString Name;
+
+    //! the shape and its presentation, a copy of the added shape if it is
+    //! meshed in the background.
+    TopoDS_Shape Shape;
+    Handle(AIS_Shape) Presentation;
+
+    //! bounding box, computed on first use.
+    Bnd_Box Box;
+    bool IsBoxValid;
+
+    //! deflections of the triangulation of the faces, 0 if not meshed by the document.
+    double MeshDeflection;
+    double MeshAngle;
+
+    //! the faces have a triangulation but no surface (stl imports), they
+    //! are never meshed and always shown shaded.
+    bool IsMeshOnly;
+
+    //! the faces are meshed on a worker thread, the bounding box is shown instead.
+    bool IsMeshing;
+    Handle(AIS_Shape) Placeholder;
+};
+
+//! The shapes of the scene, each with its presentation and cached data.
+//!
+//! Import, modeling and export all go through the document, so that saving
+//! writes every displayed object and the bounding boxes and triangulations
+//! of the objects are computed once and reused.
+//!
+//! Shapes with many faces are meshed for the shaded display on a worker
+//! thread, their bounding box is shown until the mesh is done.
+class occDocument : public QObject
+{
+    Q_OBJECT
+
+public:
+    //! constructor/destructor, the destructor waits for running meshes.
+    occDocument(const Handle(AIS_InteractiveContext)& theContext, QObject *parent = nullptr);
+    ~occDocument();
+
+    //! add and display a presentation, the viewer is updated if toUpdate.
+    //! @return index of the new entry.
+    int add(const Handle(AIS_Shape)& thePresentation, const QString& theName, bool toUpdate = true);
+
+    //! add() does not update the viewer until the matching commitBatch(),
+    //! batches may be nested.
+    void beginBatch(void);
+
+    //! end a batch, the outermost one updates the viewer once if toUpdate.
+    //! pass false when the caller redraws anyway, e.g. by fitting the view.
+    void commitBatch(bool toUpdate = true);
+
+    //! shapes of at least theMinFaces faces are meshed in the background, 0 for never.
+    void setBackgroundMeshing(int theMinFaces);
+
+    //! wait until all shapes are meshed and displayed.
+    void waitForMeshing(void);
+
+    //! number of entries.
+    int nbEntries(void) const;
+
+    //! entry of an index, 0 <= theIndex < nbEntries().
+    const occDocumentEntry& entry(int theIndex) const;
+
+    //! index of the entry of a presentation or of its placeholder, -1 if it
+    //! is not in the document.
+    int find(const Handle(AIS_InteractiveObject)& thePresentation) const;
+
+    //! the entry is displayed in the viewer, or will be when its mesh is done.
+    bool isVisible(int theIndex) const;
+
+    //! bounding box of an entry, cached.
+    const Bnd_Box& boundingBox(int theIndex);
+
+    //! mesh the faces of an entry, skipped if it is already meshed as fine.
+    //! @param theDeflection [in] linear deflection, 0 for 0.1% of the bounding box diagonal.
+    //! @param theAngle [in] angular deflection in radians.
+    void mesh(int theIndex, double theDeflection, double theAngle);
+
+    //! remove the selected entries from the document and the viewer, other
+    //! selected objects are erased.
+    void removeSelected(void);
+
+signals:
+    //! progress of the background mesh of an entry in percent, 100 when it is displayed.
+    void meshProgress(const QString& theName, int thePercent);
+
+    //! the presentation of an entry was displayed or its triangulation changed.
+    void meshChanged(int theIndex);
+
+private slots:
+    void onMeshFinished(void);
+
+private:
+    //! append an entry and display its presentation.
+    int display(const occDocumentEntry& theEntry, bool toUpdate);
+
+    //! replace the placeholder of a meshed entry by its presentation.
+    void finishMesh(QFutureWatcher<void>* theWatcher);
+
+private:
+    Handle(AIS_InteractiveContext) myContext;
+
+    std::vector<occDocumentEntry> myEntries;
+
+    // nesting depth of beginBatch().
+    int myBatchDepth;
+
+    // shapes of at least this many faces are meshed in the background.
+    int myMinBackgroundFaces;
+
+    // running meshes, each watcher keeps the presentation it is meshing.
+    QList<QFutureWatcher<void>*> myMeshJobs;
+};
+
+#endif // OCCDOCUMENT_H
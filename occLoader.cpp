@@ -0,0 +1,213 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : occLoader.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Read CAD files on a worker thread.
+*/
+
+#include "occLoader.h"
+
+#include <QFileInfo>
+#include <QTextCodec>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <BRepTools.hxx>
+#include <BRep_Builder.hxx>
+
+#include <dxfReader.h>
+#include <stepReader.h>
+#include <stlReader.h>
+
+#include <XSControl_WorkSession.hxx>
+#include <Transfer_TransientProcess.hxx>
+#include <IGESControl_Reader.hxx>
+
+//! Forward the progress of OpenCASCADE algorithms to occLoader::progress()
+//! and stop them when the import is canceled.
+class occLoaderProgress : public Message_ProgressIndicator
+{
+public:
+    occLoaderProgress(occLoader* theLoader, const std::atomic<bool>* theCanceled)
+        : myLoader(theLoader), myCanceled(theCanceled), myPercent(-1)
+    {
+        SetScale(0.0, 100.0, 1.0);
+    }
+
+    virtual Standard_Boolean Show(const Standard_Boolean theForce) Standard_OVERRIDE
+    {
+        // the signal is queued to the GUI thread, only send changes.
+        const int aPercent = (int)(GetPosition() * 100.0);
+        if (theForce || aPercent != myPercent)
+        {
+            myPercent = aPercent;
+            emit myLoader->progress(aPercent);
+        }
+        return Standard_True;
+    }
+
+    virtual Standard_Boolean UserBreak(void) Standard_OVERRIDE
+    {
+        return myCanceled->load();
+    }
+
+private:
+    occLoader* myLoader;
+    const std::atomic<bool>* myCanceled;
+    int myPercent;
+};
+
+occLoader::occLoader(QObject *parent) : QObject(parent), myCanceled(false)
+{
+    connect(&myWatcher, SIGNAL(finished()), this, SLOT(onFinished()));
+}
+
+occLoader::~occLoader()
+{
+    cancel();
+    myWatcher.waitForFinished();
+}
+
+bool occLoader::load(const QString& theFileName)
+{
+    if (isRunning())
+    {
+        return false;
+    }
+
+    myCanceled = false;
+
+    Handle(Message_ProgressIndicator) aProgress = new occLoaderProgress(this, &myCanceled);
+    const std::atomic<bool>* aCanceled = &myCanceled;
+    const occShapeCache aCache = myCache;
+    const occLoadOptions anOptions = myOptions;
+
+    emit progress(-1);
+
+    myWatcher.setFuture(QtConcurrent::run([theFileName, aProgress, aCanceled, aCache, anOptions]()
+    {
+        occLoadResult aResult = occLoader::read(theFileName, aProgress, &aCache, anOptions);
+
+        // transfers stopped by UserBreak() return partial shapes.
+        if (aCanceled->load())
+        {
+            aResult.IsDone = false;
+            aResult.IsCanceled = true;
+            aResult.Shape.Nullify();
+            aResult.Dxf.reset();
+        }
+        return aResult;
+    }));
+
+    return true;
+}
+
+bool occLoader::isRunning(void) const
+{
+    return myWatcher.isRunning();
+}
+
+occShapeCache& occLoader::cache(void)
+{
+    return myCache;
+}
+
+occLoadOptions& occLoader::options(void)
+{
+    return myOptions;
+}
+
+void occLoader::cancel(void)
+{
+    myCanceled = true;
+}
+
+void occLoader::onFinished(void)
+{
+    emit loaded(myWatcher.result());
+}
+
+occLoadResult occLoader::read(const QString& theFileName, const Handle(Message_ProgressIndicator)& theProgress,
+    const occShapeCache* theCache, const occLoadOptions& theOptions)
+{
+    occLoadResult aResult;
+    aResult.FileName = theFileName;
+
+    QFileInfo Info(theFileName);
+    QString aSuffix = Info.suffix().toLower();
+    QTextCodec *code = QTextCodec::codecForName("GB2312");
+    std::string filename = code->fromUnicode(theFileName).data();
+
+    // brep and stl are read as fast as the cache, dxf is displayed per layer.
+    const bool isCacheable = theCache != nullptr && theCache->isEnabled() &&
+        (aSuffix == "igs" || aSuffix == "iges" || aSuffix == "stp" || aSuffix == "step");
+
+    if (isCacheable && theCache->load(theFileName, aResult.Shape))
+    {
+        aResult.IsCached = true;
+        aResult.IsDone = true;
+        return aResult;
+    }
+
+    //brep
+    if (aSuffix == "brep")
+    {
+        BRep_Builder aBuilder;
+        aResult.IsDone = BRepTools::Read(aResult.Shape, filename.c_str(), aBuilder, theProgress);
+    }
+    //dxf
+    else if (aSuffix == "dxf")
+    {
+        aResult.Dxf = std::make_shared<DxfReader>(filename, theOptions.DxfTileSize);
+        if (theOptions.DxfTolerance > 0.0)
+        {
+            aResult.Dxf->ConnectEdges(theOptions.DxfTolerance);
+        }
+        aResult.Shape = aResult.Dxf->GetShape();
+        aResult.IsDone = Standard_True;
+    }
+    //igs
+    else if (aSuffix == "igs" || aSuffix == "iges")
+    {
+        // the iges parser and the unit factors are global, one file at a time.
+        std::lock_guard<std::mutex> aLock(StepReader::TranslatorMutex());
+
+        IGESControl_Reader aReader_IGES;
+        if (aReader_IGES.ReadFile(filename.c_str()) == IFSelect_RetDone)
+        {
+            aReader_IGES.WS()->MapReader()->SetProgress(theProgress);
+            aReader_IGES.TransferRoots();
+            aReader_IGES.WS()->MapReader()->SetProgress(NULL);
+
+            aResult.Shape = aReader_IGES.OneShape();
+            aResult.IsDone = Standard_True;
+        }
+    }
+    //stp
+    else if (aSuffix == "stp" || aSuffix == "step")
+    {
+        // independent roots are transferred on all cores.
+        StepReader aReader_Step(filename, theOptions.NbThreads, theProgress);
+        aResult.Shape = aReader_Step.GetShape();
+        aResult.IsDone = aReader_Step.IsDone();
+    }
+    //stl
+    else if (aSuffix == "stl")
+    {
+        // one triangulated face instead of a face per triangle.
+        StlReader aReader_Stl(filename);
+        aResult.Shape = aReader_Stl.GetShape();
+        aResult.IsDone = aReader_Stl.IsDone();
+    }
+
+    // a canceled transfer may have left a partial shape.
+    if (isCacheable && aResult.IsDone && (theProgress.IsNull() || !theProgress->UserBreak()))
+    {
+        theCache->store(theFileName, aResult.Shape);
+    }
+
+    return aResult;
+}
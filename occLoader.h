@@ -0,0 +1,125 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : occLoader.h
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Read CAD files on a worker thread.
+*/
+
+#ifndef OCCLOADER_H
+#define OCCLOADER_H
+
+#include <atomic>
+#include <memory>
+
+#include <QObject>
+#include <QString>
+#include <QFutureWatcher>
+
+#include <TopoDS_Shape.hxx>
+#include <Message_ProgressIndicator.hxx>
+
+#include "occShapeCache.h"
+
+class DxfReader;
+
+//! shape read from a CAD file.
+struct occLoadResult
+{
+    occLoadResult(void) : IsCached(false), IsDone(false), IsCanceled(false) {}
+
+    //! file name as given to occLoader::load().
+    QString FileName;
+
+    //! the shape was read from the cache.
+    bool IsCached;
+
+    //! the file could be read.
+    bool IsDone;
+
+    //! the user canceled the import, the shape is null.
+    bool IsCanceled;
+
+    //! shape of brep, iges, step and stl files.
+    TopoDS_Shape Shape;
+
+    //! reader of dxf files, the parts are displayed per layer.
+    std::shared_ptr<DxfReader> Dxf;
+};
+
+//! settings of an import.
+struct occLoadOptions
+{
+    occLoadOptions(void) : NbThreads(0), DxfTileSize(0.0), DxfTolerance(1.0e-6) {}
+
+    //! step roots are transferred on this many threads, 0 for one per core.
+    //! only OCCT 7.8 and later transfer roots in parallel, older versions
+    //! read on one thread whatever is given, see StepReader.
+    int NbThreads;
+
+    //! dxf layers are split into square tiles of this size, 0 for no tiles.
+    double DxfTileSize;
+
+    //! loose dxf edges with ends closer than this are chained into wires,
+    //! 0 for not chained.
+    double DxfTolerance;
+};
+
+//! Read and transfer CAD files on a worker thread, so the GUI keeps
+//! running. Only the finished shape is handed back to the GUI thread.
+class occLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    //! constructor/destructor, the destructor cancels and waits for a running import.
+    occLoader(QObject *parent = nullptr);
+    ~occLoader();
+
+    //! start reading the file, false if an import is still running.
+    bool load(const QString& theFileName);
+
+    //! an import is running.
+    bool isRunning(void) const;
+
+    //! cache of translated iges and step files, used by the next load().
+    occShapeCache& cache(void);
+
+    //! settings of the next load().
+    occLoadOptions& options(void);
+
+    //! read the file on the calling thread, the format is chosen by the suffix.
+    //! translated shapes are taken from and written to the cache if one is given.
+    static occLoadResult read(const QString& theFileName, const Handle(Message_ProgressIndicator)& theProgress,
+        const occShapeCache* theCache = nullptr, const occLoadOptions& theOptions = occLoadOptions());
+
+public slots:
+    //! stop the running import, loaded() reports it as canceled.
+    void cancel(void);
+
+signals:
+    //! progress in percent, -1 while it is unknown.
+    void progress(int thePercent);
+
+    //! the import is finished, emitted on the GUI thread.
+    void loaded(const occLoadResult& theResult);
+
+private slots:
+    void onFinished(void);
+
+private:
+    // running import.
+    QFutureWatcher<occLoadResult> myWatcher;
+
+    // set by cancel(), polled by the progress indicator of the worker.
+    std::atomic<bool> myCanceled;
+
+    // settings of the cache and of the import, copied for each import.
+    occShapeCache myCache;
+    occLoadOptions myOptions;
+};
+
+#endif // OCCLOADER_H
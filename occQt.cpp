@@ -11,16 +11,20 @@
 
 #include "occQt.h"
 #include "occView.h"
+#include "occDocument.h"
 
 #include <QToolBar>
 #include <QTreeView>
 #include <QMessageBox>
 #include <QDockWidget>
-#include <QTextCodec>
 #include <QFileDialog>
 #include <QMimeData>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QProgressBar>
+#include <QInputDialog>
+#include <QApplication>
+#include <QPushButton>
 
 #include <gp_Circ.hxx>
 #include <gp_Elips.hxx>
@@ -41,7 +45,6 @@
 #include <TColgp_Array1OfPnt2d.hxx>
 
 #include <BRepLib.hxx>
-#include <BRepTools.hxx>
 #include <BRep_Tool.hxx>
 #include <BRep_Builder.hxx>
 
@@ -74,24 +77,35 @@
 
 #include <AIS_Shape.hxx>
 
-#include <Interface_Static.hxx>
-#include <IGESControl_Reader.hxx>
-#include <IGESControl_Writer.hxx>
-#include <IGESControl_Controller.hxx>
-#include <STEPControl_Reader.hxx>
-#include <STEPControl_Writer.hxx>
-#include <StlAPI_Reader.hxx>
-#include <StlAPI_Writer.hxx>
+#include <occWriter.h>
 
+#include <OSD_Timer.hxx>
 
-occQt::occQt(QWidget *parent) : QMainWindow(parent)
+
+occQt::occQt(QWidget *parent) : QMainWindow(parent),
+    myStlDeflection(0.0),
+    myStlAngle(20.0)
 {
     ui.setupUi(this);
 
     myOccView = new OccView(this);
 
+    myDocument = new occDocument(myOccView->getContext());
+    connect(myDocument, SIGNAL(meshProgress(QString, int)), this, SLOT(onMeshProgress(QString, int)));
+    connect(myDocument, SIGNAL(meshChanged(int)), this, SLOT(onMeshChanged(int)));
+
     setCentralWidget(myOccView);
 
+    myLoader = new occLoader(this);
+
+    myProgressBar = new QProgressBar(this);
+    myProgressBar->setMaximumWidth(200);
+    myProgressBar->hide();
+    myCancelButton = new QPushButton(tr(u8"Cancel"), this);
+    myCancelButton->hide();
+    ui.statusBar->addPermanentWidget(myProgressBar);
+    ui.statusBar->addPermanentWidget(myCancelButton);
+
     createActions();
     createMenus();
     createToolBars();
@@ -102,6 +116,7 @@ occQt::occQt(QWidget *parent) : QMainWindow(parent)
 
 occQt::~occQt()
 {
+    delete myDocument;
 
 }
 
@@ -119,6 +134,7 @@ void occQt::createActions( void )
 
     connect(ui.actionReset, SIGNAL(triggered()), myOccView, SLOT(reset()));
     connect(ui.actionFitAll, SIGNAL(triggered()), myOccView, SLOT(fitAll()));
+    connect(myOccView, SIGNAL(frameStatistics(double, double, double)), this, SLOT(onFrameStatistics(double, double, double)));
     connect(ui.actionDelete, SIGNAL(triggered()), this, SLOT(shapeDelete()));
 
     // Primitive
@@ -162,6 +178,19 @@ void occQt::createActions( void )
 
     // Help
     connect(ui.actionAbout, SIGNAL(triggered()), this, SLOT(about()));
+
+    // Import
+    myCacheAction = new QAction(tr(u8"Use Import Cache"), this);
+    myCacheAction->setCheckable(true);
+    myCacheAction->setChecked(myLoader->cache().isEnabled());
+    connect(myCacheAction, SIGNAL(toggled(bool)), this, SLOT(useCache(bool)));
+
+    myDxfAction = new QAction(tr(u8"DXF Import Options..."), this);
+    connect(myDxfAction, SIGNAL(triggered()), this, SLOT(dxfOptions()));
+
+    connect(myLoader, SIGNAL(progress(int)), this, SLOT(onLoadProgress(int)));
+    connect(myLoader, SIGNAL(loaded(occLoadResult)), this, SLOT(onLoaded(occLoadResult)));
+    connect(myCancelButton, SIGNAL(clicked()), myLoader, SLOT(cancel()));
 }
 
 void occQt::createMenus( void )
@@ -174,6 +203,8 @@ void occQt::createMenus( void )
     menu_1->setTitle(QString::fromUtf8("File"));
     menu_1->addAction(ui.actionOpen);
     menu_1->addAction(ui.actionSave);
+    menu_1->addAction(myCacheAction);
+    menu_1->addAction(myDxfAction);
     menu_1->addAction(ui.actionExit);
 
     QMenu *menu_2 = new QMenu(menuBar);
@@ -301,69 +332,14 @@ void occQt::open()
     }
     else
     {
-        QFileInfo Info(FileName);
-        dirPath = Info.path();
-        QTextCodec *code = QTextCodec::codecForName("GB2312");
-        std::string filename = code->fromUnicode(FileName).data();
-
-        TopoDS_Shape aShape;
-
-        //brep
-        if (Info.suffix().toLower() == "brep")
-        {
-            BRep_Builder aBuilder;
-            Standard_Boolean result = BRepTools::Read(aShape, filename.c_str(), aBuilder);
-            if (result)
-                theShape = aShape; 
-        }
-        //dxf
-        if (Info.suffix().toLower() == "dxf")
-        {
-            DxfReader aDxfReader(filename);
-            aShape = aDxfReader.GetShape();
-            theShape = aShape;
-        }
-        //igs
-        if (Info.suffix().toLower() == "igs" || Info.suffix().toLower() == "iges")
-        {
-            IGESControl_Reader aReader_IGES;
-            aReader_IGES.ReadFile(filename.c_str());
-            aReader_IGES.PrintCheckLoad(Standard_False, IFSelect_ItemsByEntity);
-            Standard_Integer NbRoots = aReader_IGES.NbRootsForTransfer();
-            Standard_Integer num = aReader_IGES.TransferRoots();
-            aShape = aReader_IGES.OneShape();
-            theShape = aShape;
-        }
-        //stp
-        if (Info.suffix().toLower() == "stp" || Info.suffix().toLower() == "step")
-        {
-            STEPControl_Reader aReader_Step;
-            aReader_Step.ReadFile(filename.c_str());
-            aReader_Step.PrintCheckLoad(Standard_False, IFSelect_ItemsByEntity);
-            Standard_Integer NbRoots = aReader_Step.NbRootsForTransfer();
-            Standard_Integer num = aReader_Step.TransferRoots();
-            aShape = aReader_Step.OneShape();
-            theShape = aShape;
-        }
-        //stl
-        if (Info.suffix().toLower() == "stl")
-        {
-            StlAPI_Reader aReader_Stl;
-            aReader_Stl.Read(aShape, filename.c_str());
-            theShape = aShape;
-        }
-
-        Handle(AIS_Shape) anAisModel = new AIS_Shape(aShape);
-        anAisModel->SetColor(Quantity_NOC_GRAY);
-        anAisModel->SetTransparency(0);
-        myOccView->getContext()->Display(anAisModel, Standard_True);
-        myOccView->fitAll();
+        loadFile(FileName);
     }
 }
 
 void occQt::save()
 {
-    QString FileName = QFileDialog::getSaveFileName(this, tr(u8"Information"), dirPath, "*.brep;; *.iges;; *.step;; *.stl");
+    QString Filter;
+    QString FileName = QFileDialog::getSaveFileName(this, tr(u8"Information"), dirPath, "*.brep;; *.iges;; *.step;; *.stl;; *.dxf;; Outline (*.dxf)", &Filter);
 
     if (FileName.isEmpty())
     {
@@ -373,79 +349,93 @@ void occQt::save()
     {
         QFileInfo file(FileName);
         dirPath = file.path();
-        QTextCodec *code = QTextCodec::codecForName("GB2312");
-        std::string filename = code->fromUnicode(FileName).data();
 
         const QString ext = file.suffix().toLower();
 
+        // every displayed object of the document is saved, with its mesh done.
+        myDocument->waitForMeshing();
+
         Handle(TopTools_HSequenceOfShape) aSequence = new TopTools_HSequenceOfShape();
         aSequence->Clear();
-        aSequence->Append(theShape);
+        for (int i = 0; i < myDocument->nbEntries(); i++)
+        {
+            if (myDocument->isVisible(i))
+                aSequence->Append(myDocument->entry(i).Shape);
+        }
+
+        if (aSequence->IsEmpty())
+            return;
+
+        occWriteOptions anOptions;
 
-        //brep
-        if (ext == "brep")
+        //stl
+        if (ext == "stl")
         {
-            if (aSequence.IsNull() || aSequence->IsEmpty())
+            // tessellation of the export, 0 for relative to the model size.
+            bool isOk = false;
+            double aDeflection = QInputDialog::getDouble(this, tr(u8"STL Export"), tr(u8"Linear deflection (0 = automatic):"),
+                myStlDeflection, 0.0, 1.0e6, 4, &isOk);
+            if (!isOk)
+                return;
+            double anAngle = QInputDialog::getDouble(this, tr(u8"STL Export"), tr(u8"Angular deflection (degree):"),
+                myStlAngle, 1.0, 90.0, 1, &isOk);
+            if (!isOk)
                 return;
+            myStlDeflection = aDeflection;
+            myStlAngle = anAngle;
 
-            TopoDS_Shape shape = aSequence->Value(1);
-            BRepTools::Write(shape, filename.c_str());
+            anOptions.StlDeflection = myStlDeflection;
+            anOptions.StlAngle = myStlAngle * M_PI / 180.0;
+            anOptions.IsMeshed = true;
         }
-        //igs
-        if (ext == "iges")
+        //dxf
+        if (ext == "dxf" && Filter.startsWith("Outline"))
         {
-            if (aSequence.IsNull() || aSequence->IsEmpty())
-                return;
+            // hidden line removal in the current view direction.
+            Standard_Real aProjX, aProjY, aProjZ, anUpX, anUpY, anUpZ;
+            myOccView->getView()->Proj(aProjX, aProjY, aProjZ);
+            myOccView->getView()->Up(anUpX, anUpY, anUpZ);
 
-            IGESControl_Controller::Init();
-            IGESControl_Writer writer(Interface_Static::CVal("XSTEP.iges.unit"),
-                                      Interface_Static::IVal("XSTEP.iges.writebrep.mode"));
+            gp_Dir aProj(aProjX, aProjY, aProjZ);
+            gp_Dir anUp(anUpX, anUpY, anUpZ);
 
-            for (int i = 1; i <= aSequence->Length(); i++)
-            {
-                writer.AddShape(aSequence->Value(i));
-            }
-            writer.ComputeModel();
-            writer.Write(filename.c_str());
+            anOptions.IsOutline = true;
+            anOptions.OutlineView = gp_Ax2(gp::Origin(), aProj, anUp.Crossed(aProj));
         }
-        //stp
-        if (ext == "step")
-        {
-            if (aSequence.IsNull() || aSequence->IsEmpty())
-                return;
 
-            STEPControl_StepModelType type = STEPControl_AsIs;
-            IFSelect_ReturnStatus status;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
 
-            STEPControl_Writer writer;
-            for (int i = 1; i <= aSequence->Length(); i++)
+        // objects keep their triangulation, a second export with the
+        // same deflection does not mesh again.
+        OSD_Timer aMeshTimer;
+        if (anOptions.IsMeshed)
+        {
+            aMeshTimer.Start();
+            for (int i = 0; i < myDocument->nbEntries(); i++)
             {
-                status = writer.Transfer(aSequence->Value(i), type);
-                if (status != IFSelect_RetDone)
-                    return;
+                if (myDocument->isVisible(i))
+                    myDocument->mesh(i, anOptions.StlDeflection, anOptions.StlAngle);
             }
-            writer.Write(filename.c_str());
+            aMeshTimer.Stop();
         }
-        //stl
+
+        occWriter aWriter(anOptions);
+        bool isDone = aWriter.write(FileName, aSequence);
+        QApplication::restoreOverrideCursor();
+
+        if (!isDone)
+        {
+            QMessageBox::warning(this, tr(u8"Warning"), tr(u8"Can not write %1!").arg(file.fileName()));
+            return;
+        }
+
         if (ext == "stl")
         {
-            if (aSequence.IsNull() || aSequence->IsEmpty())
-                    return;
-
-                TopoDS_Compound res;
-                BRep_Builder builder;
-                builder.MakeCompound(res);
-
-                for (int i = 1; i <= aSequence->Length(); i++)
-                {
-                    TopoDS_Shape shape = aSequence->Value(i);
-                    if (shape.IsNull())
-                        return;
-
-                    builder.Add(res, shape);
-                }
-                StlAPI_Writer writer;
-                writer.Write(res, filename.c_str());
+            const double aMeshTime = aMeshTimer.ElapsedTime();
+            const double aTime = aMeshTime + aWriter.writeTime();
+            ui.statusBar->showMessage(tr(u8"%1 triangles in %2 s (mesh %3 s, write %4 s), %5 triangles/s")
+                .arg(aWriter.nbTriangles()).arg(aTime, 0, 'f', 2).arg(aMeshTime, 0, 'f', 2)
+                .arg(aWriter.writeTime(), 0, 'f', 2).arg(aTime > 0.0 ? aWriter.nbTriangles() / aTime : 0.0, 0, 'f', 0));
         }
     }
 }
@@ -457,7 +447,7 @@ void occQt::makeBox()
 
     anAisBox->SetColor(Quantity_NOC_AZURE);
 
-    myOccView->getContext()->Display(anAisBox, Standard_True);
+    myDocument->add(anAisBox, "Box", false);
     myOccView->fitAll();
 }
 
@@ -477,8 +467,10 @@ void occQt::makeCone()
 
     anAisCone->SetColor(Quantity_NOC_CHOCOLATE);
 
-    myOccView->getContext()->Display(anAisReducer, Standard_True);
-    myOccView->getContext()->Display(anAisCone, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisReducer, "Reducer");
+    myDocument->add(anAisCone, "Cone");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
@@ -492,7 +484,7 @@ void occQt::makeSphere()
 
     anAisSphere->SetColor(Quantity_NOC_BLUE1);
 
-    myOccView->getContext()->Display(anAisSphere, Standard_True);
+    myDocument->add(anAisSphere, "Sphere", false);
     myOccView->fitAll();
 }
 
@@ -512,8 +504,10 @@ void occQt::makeCylinder()
 
     anAisPie->SetColor(Quantity_NOC_TAN);
 
-    myOccView->getContext()->Display(anAisCylinder, Standard_True);
-    myOccView->getContext()->Display(anAisPie, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisCylinder, "Cylinder");
+    myDocument->add(anAisPie, "Pie");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
@@ -533,8 +527,10 @@ void occQt::makeTorus()
 
     anAisElbow->SetColor(Quantity_NOC_THISTLE);
 
-    myOccView->getContext()->Display(anAisTorus, Standard_True);
-    myOccView->getContext()->Display(anAisElbow, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisTorus, "Torus");
+    myDocument->add(anAisElbow, "Elbow");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
@@ -555,7 +551,7 @@ void occQt::makeFillet()
     Handle(AIS_Shape) anAisShape = new AIS_Shape(MF.Shape());
     anAisShape->SetColor(Quantity_NOC_VIOLET);
 
-    myOccView->getContext()->Display(anAisShape, Standard_True);
+    myDocument->add(anAisShape, "Shape", false);
     myOccView->fitAll();
 }
 
@@ -581,7 +577,7 @@ void occQt::makeChamfer()
     Handle(AIS_Shape) anAisShape = new AIS_Shape(MC.Shape());
     anAisShape->SetColor(Quantity_NOC_TOMATO);
 
-    myOccView->getContext()->Display(anAisShape, Standard_True);
+    myDocument->add(anAisShape, "Shape", false);
     myOccView->fitAll();
 }
 
@@ -619,10 +615,12 @@ void occQt::makeExtrude()
     anAisPrismCircle->SetColor(Quantity_NOC_PERU);
     anAisPrismEllipse->SetColor(Quantity_NOC_PINK);
 
-    myOccView->getContext()->Display(anAisPrismVertex, Standard_True);
-    myOccView->getContext()->Display(anAisPrismEdge, Standard_True);
-    myOccView->getContext()->Display(anAisPrismCircle, Standard_True);
-    myOccView->getContext()->Display(anAisPrismEllipse, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisPrismVertex, "PrismVertex");
+    myDocument->add(anAisPrismEdge, "PrismEdge");
+    myDocument->add(anAisPrismCircle, "PrismCircle");
+    myDocument->add(anAisPrismEllipse, "PrismEllipse");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
@@ -666,10 +664,12 @@ void occQt::makeRevol()
     anAisRevolCircle->SetColor(Quantity_NOC_MAGENTA1);
     anAisRevolEllipse->SetColor(Quantity_NOC_MAROON);
 
-    myOccView->getContext()->Display(anAisRevolVertex, Standard_True);
-    myOccView->getContext()->Display(anAisRevolEdge, Standard_True);
-    myOccView->getContext()->Display(anAisRevolCircle, Standard_True);
-    myOccView->getContext()->Display(anAisRevolEllipse, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisRevolVertex, "RevolVertex");
+    myDocument->add(anAisRevolEdge, "RevolEdge");
+    myDocument->add(anAisRevolCircle, "RevolCircle");
+    myDocument->add(anAisRevolEllipse, "RevolEllipse");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
@@ -707,8 +707,10 @@ void occQt::makeLoft()
     anAisShell->SetColor(Quantity_NOC_OLIVEDRAB);
     anAisSolid->SetColor(Quantity_NOC_PEACHPUFF);
 
-    myOccView->getContext()->Display(anAisShell, Standard_True);
-    myOccView->getContext()->Display(anAisSolid, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisShell, "Shell");
+    myDocument->add(anAisSolid, "Solid");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
@@ -739,10 +741,12 @@ void occQt::testCut()
     anAisCuttedShape1->SetColor(Quantity_NOC_TAN);
     anAisCuttedShape2->SetColor(Quantity_NOC_SALMON);
 
-    myOccView->getContext()->Display(anAisBox, Standard_True);
-    myOccView->getContext()->Display(anAisSphere, Standard_True);
-    myOccView->getContext()->Display(anAisCuttedShape1, Standard_True);
-    myOccView->getContext()->Display(anAisCuttedShape2, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisBox, "Box");
+    myDocument->add(anAisSphere, "Sphere");
+    myDocument->add(anAisCuttedShape1, "CuttedShape1");
+    myDocument->add(anAisCuttedShape2, "CuttedShape2");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
@@ -767,9 +771,11 @@ void occQt::testFuse()
     anAisSphere->SetColor(Quantity_NOC_STEELBLUE);
     anAisFusedShape->SetColor(Quantity_NOC_ROSYBROWN);
 
-    myOccView->getContext()->Display(anAisBox, Standard_True);
-    myOccView->getContext()->Display(anAisSphere, Standard_True);
-    myOccView->getContext()->Display(anAisFusedShape, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisBox, "Box");
+    myDocument->add(anAisSphere, "Sphere");
+    myDocument->add(anAisFusedShape, "FusedShape");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
@@ -794,19 +800,26 @@ void occQt::testCommon()
     anAisSphere->SetColor(Quantity_NOC_STEELBLUE);
     anAisCommonShape->SetColor(Quantity_NOC_ROYALBLUE);
 
-    myOccView->getContext()->Display(anAisBox, Standard_True);
-    myOccView->getContext()->Display(anAisSphere, Standard_True);
-    myOccView->getContext()->Display(anAisCommonShape, Standard_True);
+    myDocument->beginBatch();
+    myDocument->add(anAisBox, "Box");
+    myDocument->add(anAisSphere, "Sphere");
+    myDocument->add(anAisCommonShape, "CommonShape");
+    myDocument->commitBatch(false);
     myOccView->fitAll();
 }
 
 void occQt::testHelix()
 {
+    myDocument->beginBatch();
+
     makeCylindricalHelix();
 
     makeConicalHelix();
 
     makeToroidalHelix();
+
+    myDocument->commitBatch(false);
+    myOccView->fitAll();
 }
 
 void occQt::viewBack()
@@ -853,9 +866,7 @@ void occQt::viewTop()
 
 void occQt::shapeDelete()
 {
-    myOccView->getContext()->EraseSelected (Standard_False);
-    myOccView->getContext()->ClearSelected (Standard_False);
-    myOccView->getContext()->UpdateCurrentViewer();
+    myDocument->removeSelected();
 }
 
 void occQt::showWireFrame()
@@ -868,6 +879,25 @@ void occQt::showShading()
     myOccView->getContext()->SetDisplayMode(1, true);
 }
 
+void occQt::dxfOptions()
+{
+    occLoadOptions& anOptions = myLoader->options();
+
+    // tiles make many small presentations of large drawings.
+    bool isOk = false;
+    double aTileSize = QInputDialog::getDouble(this, tr(u8"DXF Import"), tr(u8"Tile size (0 = one part per layer):"),
+        anOptions.DxfTileSize, 0.0, 1.0e9, 2, &isOk);
+    if (!isOk)
+        return;
+    double aTolerance = QInputDialog::getDouble(this, tr(u8"DXF Import"), tr(u8"Edge chaining tolerance (0 = off):"),
+        anOptions.DxfTolerance, 0.0, 1.0e3, 7, &isOk);
+    if (!isOk)
+        return;
+
+    anOptions.DxfTileSize = aTileSize;
+    anOptions.DxfTolerance = aTolerance;
+}
+
 void occQt::makeCylindricalHelix()
 {
     Standard_Real aRadius = 3.0;
@@ -888,7 +918,7 @@ void occQt::makeCylindricalHelix()
 
     Handle(AIS_Shape) anAisHelixCurve = new AIS_Shape(aTransform.Shape());
 
-    myOccView->getContext()->Display(anAisHelixCurve, Standard_True);
+    myDocument->add(anAisHelixCurve, "HelixCurve");
 
     // sweep a circle profile along the helix curve.
     // there is no curve3d in the pcurve edge, so approx one.
@@ -915,8 +945,7 @@ void occQt::makeCylindricalHelix()
 
         Handle(AIS_Shape) anAisPipe = new AIS_Shape(aPipeTransform.Shape());
         anAisPipe->SetColor(Quantity_NOC_CORAL);
-        myOccView->getContext()->Display(anAisPipe, Standard_True);
-        myOccView->fitAll();
+        myDocument->add(anAisPipe, "Pipe");
     }
 }
 
@@ -944,7 +973,7 @@ void occQt::makeConicalHelix()
 
     Handle(AIS_Shape) anAisHelixCurve = new AIS_Shape(aTransform.Shape());
 
-    myOccView->getContext()->Display(anAisHelixCurve, Standard_True);
+    myDocument->add(anAisHelixCurve, "HelixCurve");
 
     // sweep a circle profile along the helix curve.
     // there is no curve3d in the pcurve edge, so approx one.
@@ -971,8 +1000,7 @@ void occQt::makeConicalHelix()
 
         Handle(AIS_Shape) anAisPipe = new AIS_Shape(aPipeTransform.Shape());
         anAisPipe->SetColor(Quantity_NOC_DARKGOLDENROD);
-        myOccView->getContext()->Display(anAisPipe, Standard_True);
-        myOccView->fitAll();
+        myDocument->add(anAisPipe, "Pipe");
     }
 }
 
@@ -996,7 +1024,7 @@ void occQt::makeToroidalHelix()
 
     Handle(AIS_Shape) anAisHelixCurve = new AIS_Shape(aTransform.Shape());
 
-    myOccView->getContext()->Display(anAisHelixCurve, Standard_True);
+    myDocument->add(anAisHelixCurve, "HelixCurve");
 
     // sweep a circle profile along the helix curve.
     // there is no curve3d in the pcurve edge, so approx one.
@@ -1023,9 +1051,24 @@ void occQt::makeToroidalHelix()
 
         Handle(AIS_Shape) anAisPipe = new AIS_Shape(aPipeTransform.Shape());
         anAisPipe->SetColor(Quantity_NOC_CORNSILK1);
-        myOccView->getContext()->Display(anAisPipe, Standard_True);
-        myOccView->fitAll();
+        myDocument->add(anAisPipe, "Pipe");
+    }
+}
+
+void occQt::displayDxf(const DxfReader& theReader)
+{
+    // one presentation per layer, so layers are displayed, hidden and
+    // recomputed independently.
+    myDocument->beginBatch();
+    for (int i = 0; i < theReader.NbParts(); i++)
+    {
+        Handle(AIS_Shape) anAisPart = new AIS_Shape(theReader.GetPart(i));
+        anAisPart->SetColor(Quantity_NOC_GRAY);
+        anAisPart->SetTransparency(0);
+        myDocument->add(anAisPart, QString::fromLocal8Bit(theReader.GetPartLayer(i).c_str()));
     }
+    myDocument->commitBatch(false);
+    myOccView->fitAll();
 }
 
 void occQt::dragEnterEvent(QDragEnterEvent *event)
@@ -1041,61 +1084,108 @@ void occQt::dropEvent(QDropEvent *event)
     QList<QUrl> urls = event->mimeData()->urls();
     QString Filename = urls.first().toLocalFile();
 
-    QFileInfo Info(Filename);
+    loadFile(Filename);
+}
+
+void occQt::loadFile(const QString& theFileName)
+{
+    if (myLoader->isRunning())
+    {
+        QMessageBox::information(this, tr(u8"Information"), tr(u8"Another CAD document is being opened!"));
+        return;
+    }
+
+    QFileInfo Info(theFileName);
     dirPath = Info.path();
-    QTextCodec *code = QTextCodec::codecForName("GB2312");
-    std::string filename = code->fromUnicode(Filename).data();
 
-    TopoDS_Shape aShape;
+    // the file is read and transferred on a worker thread, the shape is
+    // displayed by onLoaded().
+    myLoader->load(theFileName);
+
+    ui.actionOpen->setEnabled(false);
+    myProgressBar->show();
+    myCancelButton->show();
+    ui.statusBar->showMessage(tr(u8"Opening %1 ...").arg(Info.fileName()));
+}
 
-    //brep
-    if (Info.suffix().toLower() == "brep")
+void occQt::onLoadProgress(int thePercent)
+{
+    // busy indicator while the progress is unknown.
+    if (thePercent < 0)
     {
-        BRep_Builder aBuilder;
-        Standard_Boolean result = BRepTools::Read(aShape, filename.c_str(), aBuilder);
-        if (result)
-            theShape = aShape;
+        myProgressBar->setRange(0, 0);
     }
-    //dxf
-    if (Info.suffix().toLower() == "dxf")
+    else
     {
-        DxfReader aDxfReader(filename);
-        aShape = aDxfReader.GetShape();
-        theShape = aShape;
+        myProgressBar->setRange(0, 100);
+        myProgressBar->setValue(thePercent);
     }
-    //igs
-    if (Info.suffix().toLower() == "igs" || Info.suffix().toLower() == "iges")
+}
+
+void occQt::onLoaded(const occLoadResult& theResult)
+{
+    ui.actionOpen->setEnabled(true);
+    myProgressBar->hide();
+    myCancelButton->hide();
+    ui.statusBar->clearMessage();
+
+    QFileInfo Info(theResult.FileName);
+
+    if (theResult.IsCanceled)
     {
-        IGESControl_Reader aReader_IGES;
-        aReader_IGES.ReadFile(filename.c_str());
-        aReader_IGES.PrintCheckLoad(Standard_False, IFSelect_ItemsByEntity);
-        Standard_Integer NbRoots = aReader_IGES.NbRootsForTransfer();
-        Standard_Integer num = aReader_IGES.TransferRoots();
-        aShape = aReader_IGES.OneShape();
-        theShape = aShape;
+        ui.statusBar->showMessage(tr(u8"Opening %1 canceled.").arg(Info.fileName()), 5000);
+        return;
     }
-    //stp
-    if (Info.suffix().toLower() == "stp" || Info.suffix().toLower() == "step")
+
+    if (!theResult.IsDone)
+    {
+        QMessageBox::warning(this, tr(u8"Warning"), tr(u8"Can not read %1!").arg(Info.fileName()));
+        return;
+    }
+
+    if (theResult.IsCached)
     {
-        STEPControl_Reader aReader_Step;
-        aReader_Step.ReadFile(filename.c_str());
-        aReader_Step.PrintCheckLoad(Standard_False, IFSelect_ItemsByEntity);
-        Standard_Integer NbRoots = aReader_Step.NbRootsForTransfer();
-        Standard_Integer num = aReader_Step.TransferRoots();
-        aShape = aReader_Step.OneShape();
-        theShape = aShape;
+        ui.statusBar->showMessage(tr(u8"%1 read from the import cache.").arg(Info.fileName()), 5000);
     }
-    //stl
-    if (Info.suffix().toLower() == "stl")
+
+    //dxf
+    if (theResult.Dxf)
     {
-        StlAPI_Reader aReader_Stl;
-        aReader_Stl.Read(aShape, filename.c_str());
-        theShape = aShape;
+        displayDxf(*theResult.Dxf);
+        return;
     }
 
-    Handle(AIS_Shape) anAisModel = new AIS_Shape(aShape);
+    Handle(AIS_Shape) anAisModel = new AIS_Shape(theResult.Shape);
     anAisModel->SetColor(Quantity_NOC_GRAY);
     anAisModel->SetTransparency(0);
-    myOccView->getContext()->Display(anAisModel, Standard_True);
+    myDocument->add(anAisModel, Info.fileName(), false);
     myOccView->fitAll();
 }
+
+void occQt::useCache(bool isEnabled)
+{
+    myLoader->cache().setEnabled(isEnabled);
+}
+
+void occQt::onFrameStatistics(double theFps, double theMeanTime, double theMaxTime)
+{
+    ui.statusBar->showMessage(tr(u8"%1 fps, frame %2 ms (max %3 ms)")
+        .arg(theFps, 0, 'f', 1).arg(theMeanTime, 0, 'f', 1).arg(theMaxTime, 0, 'f', 1), 2000);
+}
+
+void occQt::onMeshProgress(const QString& theName, int thePercent)
+{
+    if (thePercent >= 100)
+    {
+        ui.statusBar->showMessage(tr(u8"%1 meshed.").arg(theName), 3000);
+    }
+    else
+    {
+        ui.statusBar->showMessage(tr(u8"Meshing %1 ... %2%").arg(theName).arg(thePercent));
+    }
+}
+
+void occQt::onMeshChanged(int theIndex)
+{
+    myOccView->prepareLod(myDocument->entry(theIndex).Presentation);
+}
@@ -13,12 +13,17 @@
 #define OCCQT_H
 
 #include "ui_occQt.h"
+#include "occLoader.h"
 
 #include <AIS_InteractiveContext.hxx>
 #include <V3d_View.hxx>
 #include <TopoDS_Shape.hxx>
 
 class OccView;
+class occDocument;
+class DxfReader;
+class QProgressBar;
+class QPushButton;
 
 //! Qt main window which include OpenCASCADE for its central widget.
 class occQt : public QMainWindow
@@ -49,6 +54,12 @@ protected:
     //! make toroidal helix.
     void makeToroidalHelix(void);
 
+    //! display the layers of a dxf drawing.
+    void displayDxf(const DxfReader& theReader);
+
+    //! start reading a CAD file in the background.
+    void loadFile(const QString& theFileName);
+
     //! drag event
     void dragEnterEvent(QDragEnterEvent *event);
 
@@ -137,12 +148,37 @@ private slots:
     //! show Shading.
     void showShading(void);
 
+    //! show the progress of the running import.
+    void onLoadProgress(int thePercent);
+
+    //! display the shape of a finished import.
+    void onLoaded(const occLoadResult& theResult);
+
+    //! switch the import cache on or off.
+    void useCache(bool isEnabled);
+
+    //! ask for the tile size and the edge tolerance of dxf imports.
+    void dxfOptions(void);
+
+    //! show the frame rate of the view while it is moved.
+    void onFrameStatistics(double theFps, double theMeanTime, double theMaxTime);
+
+    //! show the progress of the background mesh of an object.
+    void onMeshProgress(const QString& theName, int thePercent);
+
+    //! count the triangles of an entry again and build its coarse mesh for dragging.
+    void onMeshChanged(int theIndex);
+
 private:
     // dir
     QString dirPath;
 
-    // shape
-    TopoDS_Shape theShape;
+    // shapes of the scene.
+    occDocument* myDocument;
+
+    // tessellation of the stl export, linear deflection and angle in degree.
+    double myStlDeflection;
+    double myStlAngle;
 
 private:
     // ui
@@ -150,6 +186,17 @@ private:
 
     // wrapped the widget for occ.
     OccView* myOccView;
+
+    // reads CAD files on a worker thread.
+    occLoader* myLoader;
+
+    // progress and cancel of the running import in the status bar.
+    QProgressBar* myProgressBar;
+    QPushButton* myCancelButton;
+
+    // switch of the import cache and the dxf import settings.
+    QAction* myCacheAction;
+    QAction* myDxfAction;
 };
 
 #endif // OCCQT_H
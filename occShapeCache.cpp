@@ -0,0 +1,287 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : occShapeCache.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : On disk cache of translated shapes.
+*/
+
+#include "occShapeCache.h"
+
+#include <mutex>
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextStream>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+#include <BinTools.hxx>
+#include <Standard_Failure.hxx>
+
+// version of the entries, changed when the translation of files changes.
+static const char* THE_CACHE_VERSION = "1";
+
+// the batch converter reads and writes entries from several threads, an
+// entry must not be evicted while it is read.
+static std::mutex& cacheMutex(void)
+{
+    static std::mutex aMutex;
+    return aMutex;
+}
+
+occShapeCache::occShapeCache(void) :
+    myDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/shapes"),
+    myMaximumSize(qint64(2) << 30),
+    myIsEnabled(true)
+{
+}
+
+void occShapeCache::setDirectory(const QString& theDirectory)
+{
+    myDirectory = theDirectory;
+}
+
+const QString& occShapeCache::directory(void) const
+{
+    return myDirectory;
+}
+
+void occShapeCache::setMaximumSize(qint64 theSize)
+{
+    myMaximumSize = theSize;
+}
+
+qint64 occShapeCache::maximumSize(void) const
+{
+    return myMaximumSize;
+}
+
+void occShapeCache::setEnabled(bool isEnabled)
+{
+    myIsEnabled = isEnabled;
+}
+
+bool occShapeCache::isEnabled(void) const
+{
+    return myIsEnabled;
+}
+
+bool occShapeCache::load(const QString& theFileName, TopoDS_Shape& theShape) const
+{
+    if (!myIsEnabled)
+    {
+        return false;
+    }
+
+    QByteArray aHash = contentHash(theFileName);
+    if (aHash.isEmpty())
+    {
+        return false;
+    }
+
+    QString anEntry = myDirectory + "/" + aHash + ".bin";
+
+    std::lock_guard<std::mutex> aLock(cacheMutex());
+    if (!QFile::exists(anEntry))
+    {
+        return false;
+    }
+
+    TopoDS_Shape aShape;
+    try
+    {
+        if (!BinTools::Read(aShape, QFile::encodeName(anEntry).constData()))
+        {
+            // broken entry, translated and written again.
+            QFile::remove(anEntry);
+            return false;
+        }
+    }
+    catch (Standard_Failure&)
+    {
+        // broken entry, translated and written again.
+        QFile::remove(anEntry);
+        return false;
+    }
+
+    // the modification time of an entry is its last use for the eviction.
+    QFile aFile(anEntry);
+    if (aFile.open(QIODevice::Append))
+    {
+        aFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+
+    theShape = aShape;
+    return true;
+}
+
+void occShapeCache::store(const QString& theFileName, const TopoDS_Shape& theShape) const
+{
+    if (!myIsEnabled || theShape.IsNull() || !QDir().mkpath(myDirectory))
+    {
+        return;
+    }
+
+    QByteArray aHash = contentHash(theFileName);
+    if (aHash.isEmpty())
+    {
+        return;
+    }
+
+    // written under a temporary name of its own, so a partial entry is
+    // never read and writers of the same entry do not collide.
+    QString anEntry = myDirectory + "/" + aHash + ".bin";
+    QString aTemp;
+    {
+        QTemporaryFile aTempFile(myDirectory + "/" + aHash + ".XXXXXX.tmp");
+        aTempFile.setAutoRemove(false);
+        if (!aTempFile.open())
+        {
+            return;
+        }
+        aTemp = aTempFile.fileName();
+    }
+
+    try
+    {
+        if (!BinTools::Write(theShape, QFile::encodeName(aTemp).constData()))
+        {
+            QFile::remove(aTemp);
+            return;
+        }
+    }
+    catch (Standard_Failure&)
+    {
+        QFile::remove(aTemp);
+        return;
+    }
+
+    std::lock_guard<std::mutex> aLock(cacheMutex());
+
+    QFile::remove(anEntry);
+    if (!QFile::rename(aTemp, anEntry))
+    {
+        QFile::remove(aTemp);
+        return;
+    }
+
+    evict();
+}
+
+void occShapeCache::clear(void) const
+{
+    std::lock_guard<std::mutex> aLock(cacheMutex());
+
+    QDir aDir(myDirectory);
+    QStringList aFiles = aDir.entryList(QStringList() << "*.bin" << "*.key" << "*.tmp", QDir::Files);
+    for (int i = 0; i < aFiles.size(); ++i)
+    {
+        aDir.remove(aFiles[i]);
+    }
+}
+
+QByteArray occShapeCache::contentHash(const QString& theFileName) const
+{
+    QFileInfo Info(theFileName);
+    if (!Info.isFile())
+    {
+        return QByteArray();
+    }
+
+    const QString aSize = QString::number(Info.size());
+    const QString aTime = QString::number(Info.lastModified().toMSecsSinceEpoch());
+
+    // one key file per source path.
+    QByteArray aPathHash = QCryptographicHash::hash(Info.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    QString aKeyName = myDirectory + "/" + aPathHash + ".key";
+
+    QFile aKey(aKeyName);
+    if (aKey.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QTextStream aStream(&aKey);
+        QString aKeySize, aKeyTime, aKeyHash;
+        aStream >> aKeySize >> aKeyTime >> aKeyHash;
+        if (aKeySize == aSize && aKeyTime == aTime && !aKeyHash.isEmpty())
+        {
+            return aKeyHash.toLatin1();
+        }
+        aKey.close();
+    }
+
+    QFile aFile(theFileName);
+    if (!aFile.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+
+    // the suffix and version take part, as they select the translation.
+    QCryptographicHash aHash(QCryptographicHash::Sha1);
+    aHash.addData(THE_CACHE_VERSION);
+    aHash.addData(Info.suffix().toLower().toLatin1());
+    if (!aHash.addData(&aFile))
+    {
+        return QByteArray();
+    }
+    QByteArray aResult = aHash.result().toHex();
+
+    // replaced at once, a key is never read half written.
+    QSaveFile aNewKey(aKeyName);
+    if (QDir().mkpath(myDirectory) && aNewKey.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        QTextStream aStream(&aNewKey);
+        aStream << aSize << " " << aTime << " " << aResult << "\n";
+        aStream.flush();
+        aNewKey.commit();
+    }
+
+    return aResult;
+}
+
+void occShapeCache::evict(void) const
+{
+    QDir aDir(myDirectory);
+
+    // newest first.
+    QFileInfoList anEntries = aDir.entryInfoList(QStringList() << "*.bin", QDir::Files, QDir::Time);
+
+    qint64 aSize = 0;
+    for (int i = 0; i < anEntries.size(); ++i)
+    {
+        aSize += anEntries[i].size();
+
+        // the newest entry is kept even if it is larger than the cache.
+        if (aSize > myMaximumSize && i > 0)
+        {
+            QFile::remove(anEntries[i].absoluteFilePath());
+        }
+    }
+
+    // keys of paths whose entry is gone, the file is hashed again on its next import.
+    QStringList aKeys = aDir.entryList(QStringList() << "*.key", QDir::Files);
+    for (int i = 0; i < aKeys.size(); ++i)
+    {
+        QFile aKey(aDir.filePath(aKeys[i]));
+        if (!aKey.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            continue;
+        }
+
+        QTextStream aStream(&aKey);
+        QString aKeySize, aKeyTime, aKeyHash;
+        aStream >> aKeySize >> aKeyTime >> aKeyHash;
+        aKey.close();
+
+        if (aKeyHash.isEmpty() || !aDir.exists(aKeyHash + ".bin"))
+        {
+            aKey.remove();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : occShapeCache.h
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : On disk cache of translated shapes.
+*/
+
+#ifndef OCCSHAPECACHE_H
+#define OCCSHAPECACHE_H
+
+#include <QString>
+#include <QByteArray>
+
+#include <TopoDS_Shape.hxx>
+
+//! Cache of translated shapes in the binary BRep format of BinTools.
+//!
+//! Entries are named by the SHA-1 of the source file content, so copies and
+//! renamed files hit the same entry. A small key file per source path keeps
+//! the size and modification time of the file with its content hash, so
+//! unchanged files are not hashed again. The least recently used entries
+//! are removed when the cache grows above its maximum size.
+class occShapeCache
+{
+public:
+    //! constructor, the default directory is in the cache location of the application.
+    occShapeCache(void);
+
+    //! cache directory.
+    void setDirectory(const QString& theDirectory);
+    const QString& directory(void) const;
+
+    //! maximum size of all entries in bytes.
+    void setMaximumSize(qint64 theSize);
+    qint64 maximumSize(void) const;
+
+    //! switch the cache off to always translate the files.
+    void setEnabled(bool isEnabled);
+    bool isEnabled(void) const;
+
+    //! read the shape of an unchanged file, false if there is no entry.
+    bool load(const QString& theFileName, TopoDS_Shape& theShape) const;
+
+    //! write the shape of a file and evict old entries.
+    void store(const QString& theFileName, const TopoDS_Shape& theShape) const;
+
+    //! remove all entries.
+    void clear(void) const;
+
+private:
+    //! content hash of the file, from the key file while size and time match.
+    QByteArray contentHash(const QString& theFileName) const;
+
+    //! remove the least recently used entries above the maximum size
+    //! and the key files of entries that are gone.
+    void evict(void) const;
+
+private:
+    QString myDirectory;
+
+    qint64 myMaximumSize;
+
+    bool myIsEnabled;
+};
+
+#endif // OCCSHAPECACHE_H
@@ -19,6 +19,11 @@
 #include <QRubberBand>
 #include <QStyleFactory>
 #include <QSpinBox>
+#include <QTimer>
+#include <QApplication>
+#include <QVariant>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <V3d_View.hxx>
 
@@ -35,6 +40,15 @@
 #include <Quantity_Color.hxx>
 #include <GC_MakePlane.hxx>
 #include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <Bnd_Box.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepTools.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <Poly_Triangulation.hxx>
+
+#include <stlReader.h>
 
 #ifdef WNT
     #include <WNT_Window.hxx>
@@ -68,6 +82,30 @@ OccView::OccView(QWidget* parent ) : QWidget(parent),
     myCurrentMode(CurAction3d_DynamicRotation),
     myDegenerateModeIsOn(Standard_True),
     myRectBand(NULL),
+    myHoverTimer(new QTimer(this)),
+    myIsHoverPending(false),
+    myHoverEventTime(0),
+    myFrameTimer(new QTimer(this)),
+    myDragFlags(0),
+    myIsDragPending(false),
+    myWheelSteps(0),
+    myIsRedrawPending(false),
+    myIsLodEnabled(true),
+    myIsLodActive(false),
+    myLodFrameTime(33000000),
+    myLodMinTriangles(100000),
+    myLodCoefficient(0.01),
+    myLodAngle(0.5),
+    myLodGeneration(0),
+    myNbFrames(0),
+    myFrameTimeSum(0),
+    myFrameTimeMax(0),
+    myFrameWindowStart(0),
+    myNbHoverEvents(0),
+    myNbHoverPicks(0),
+    myHoverLatencySum(0),
+    myHoverLatencyMax(0),
+    myHoverPickTimeSum(0),
     myDimDlg(new occDimensionDlg)
 {
     // No Background
@@ -81,6 +119,19 @@ OccView::OccView(QWidget* parent ) : QWidget(parent),
     // Enable the mouse tracking, by default the mouse tracking is disabled.
     setMouseTracking( true );
 
+    // Hover highlighting is picked once per frame, not on every mouse move.
+    myHoverTimer->setSingleShot(true);
+    myHoverTimer->setTimerType(Qt::PreciseTimer);
+    myHoverTimer->setInterval(16);
+    connect(myHoverTimer, SIGNAL(timeout()), this, SLOT(onHoverTimeout()));
+    myClock.start();
+
+    // Rotation, panning and zooming are applied and drawn once per frame,
+    // fast mice send many more events than can be drawn.
+    myFrameTimer->setTimerType(Qt::PreciseTimer);
+    myFrameTimer->setInterval(16);
+    connect(myFrameTimer, SIGNAL(timeout()), this, SLOT(onFrameTimeout()));
+
     init();
 }
 
@@ -148,8 +199,84 @@ QPaintEngine* OccView::paintEngine() const
     return 0;
 }
 
+void OccView::setHoverInterval( int theInterval )
+{
+    myHoverTimer->setInterval(theInterval);
+}
+
+OccView::HoverStatistics OccView::hoverStatistics( void ) const
+{
+    HoverStatistics aStatistics;
+    aStatistics.NbEvents = myNbHoverEvents;
+    aStatistics.NbPicks = myNbHoverPicks;
+    aStatistics.MeanLatency = myNbHoverPicks > 0 ? myHoverLatencySum * 1.0e-6 / myNbHoverPicks : 0.0;
+    aStatistics.MaxLatency = myHoverLatencyMax * 1.0e-6;
+    aStatistics.MeanPickTime = myNbHoverPicks > 0 ? myHoverPickTimeSum * 1.0e-6 / myNbHoverPicks : 0.0;
+    return aStatistics;
+}
+
+void OccView::resetHoverStatistics( void )
+{
+    myNbHoverEvents = 0;
+    myNbHoverPicks = 0;
+    myHoverLatencySum = 0;
+    myHoverLatencyMax = 0;
+    myHoverPickTimeSum = 0;
+}
+
+void OccView::setLodEnabled( bool isEnabled )
+{
+    myIsLodEnabled = isEnabled;
+}
+
+void OccView::setLodFrameTime( double theFrameTime )
+{
+    myLodFrameTime = (qint64)(theFrameTime * 1.0e6);
+}
+
+void OccView::setLodMinTriangles( int theMinTriangles )
+{
+    myLodMinTriangles = theMinTriangles;
+}
+
+void OccView::setLodDeflection( double theCoefficient, double theAngle )
+{
+    myLodCoefficient = theCoefficient;
+    myLodAngle = theAngle;
+
+    // The coarse meshes are made again.
+    leaveLod();
+
+    std::vector<Handle(AIS_Shape)> aShapes;
+    for (std::map<const AIS_InteractiveObject*, LodEntry>::iterator anEntry = myLodEntries.begin();
+         anEntry != myLodEntries.end(); ++anEntry)
+    {
+        if (!anEntry->second.Proxy.IsNull())
+        {
+            myContext->Remove(anEntry->second.Proxy, Standard_False);
+        }
+        if (myContext->IsDisplayed(anEntry->second.Shape))
+        {
+            aShapes.push_back(anEntry->second.Shape);
+        }
+    }
+    myLodEntries.clear();
+
+    for (size_t i = 0; i < aShapes.size(); ++i)
+    {
+        prepareLod(aShapes[i]);
+    }
+}
+
 void OccView::paintEvent( QPaintEvent* /*theEvent*/ )
 {
+    // The next frame draws the view anyway, or the timer when it stops.
+    if (myFrameTimer->isActive())
+    {
+        myIsRedrawPending = true;
+        return;
+    }
+
     myView->Redraw();
 }
 
@@ -170,6 +297,7 @@ void OccView::fitAll( void )
 
 void OccView::reset( void )
 {
+    flushFrame();
     myView->Reset();
 }
 
@@ -496,6 +624,10 @@ void OccView::mousePressEvent( QMouseEvent* theEvent )
 
 void OccView::mouseReleaseEvent( QMouseEvent* theEvent )
 {
+    // The view ends where the mouse is released, in full detail.
+    flushFrame();
+    leaveLod();
+
     if (theEvent->button() == Qt::LeftButton)
     {
         onLButtonUp(theEvent->buttons() | theEvent->modifiers(), theEvent->pos());
@@ -528,6 +660,10 @@ void OccView::onLButtonDown( const int /*theFlags*/, const QPoint thePoint )
     myXmax = thePoint.x();
     myYmax = thePoint.y();
 
+    // The selection takes the object detected under the cursor.
+    flushHover();
+    flushFrame();
+
     if (myCurrentMode == CurAction3d_DynamicRotation)
     {
         myView->StartRotation(thePoint.x(), thePoint.y());
@@ -559,23 +695,11 @@ void OccView::onMButtonDown( const int /*theFlags*/, const QPoint thePoint )
 
 void OccView::onMouseWheel( const int /*theFlags*/, const int theDelta, const QPoint thePoint )
 {
-    Standard_Integer aFactor = 16;
-
-    Standard_Integer aX = thePoint.x();
-    Standard_Integer aY = thePoint.y();
-
-    if (theDelta > 0)
-    {
-        aX += aFactor;
-        aY += aFactor;
-    }
-    else
-    {
-        aX -= aFactor;
-        aY -= aFactor;
-    }
+    // The steps of a frame are zoomed at once.
+    myWheelSteps += theDelta > 0 ? 1 : -1;
+    myWheelPoint = thePoint;
 
-    myView->Zoom(thePoint.x(), thePoint.y(), aX, aY);
+    requestFrame();
 }
 
 void OccView::addItemInPopup( QMenu* /*theMenu*/ )
@@ -597,6 +721,8 @@ void OccView::onMButtonUp( const int theFlags, const QPoint thePoint )
     // Ctrl for multi selection.
     if (thePoint.x() == myXmin && thePoint.y() == myYmin)
     {
+        flushHover();
+
         if (theFlags & Qt::ControlModifier)
         {
             multiInputEvent(thePoint.x(), thePoint.y());
@@ -632,8 +758,14 @@ void OccView::onMouseMove( const int theFlags, const QPoint thePoint )
         dragEvent(thePoint.x(), thePoint.y());
     }
 
+    // No picking while the view is dragged, the highlight would be
+    // out of date at the next frame anyway.
+    if (theFlags & (Qt::LeftButton | Qt::MidButton | Qt::RightButton))
+    {
+        cancelHover();
+    }
     // Ctrl for multi selection.
-    if (theFlags & Qt::ControlModifier)
+    else if (theFlags & Qt::ControlModifier)
     {
         multiMoveEvent(thePoint.x(), thePoint.y());
     }
@@ -642,46 +774,336 @@ void OccView::onMouseMove( const int theFlags, const QPoint thePoint )
         moveEvent(thePoint.x(), thePoint.y());
     }
 
-    // Left button.
-    if (theFlags & Qt::LeftButton)
+    // Left and right button, only the last position of the frame is applied.
+    if (theFlags & (Qt::LeftButton | Qt::RightButton))
+    {
+        myDragPoint = thePoint;
+        myDragFlags = theFlags;
+        myIsDragPending = true;
+
+        requestFrame();
+    }
+
+}
+
+void OccView::requestFrame( void )
+{
+    if (!myFrameTimer->isActive())
+    {
+        myFrameTimer->start();
+    }
+}
+
+void OccView::flushFrame( void )
+{
+    if (myIsDragPending || myWheelSteps != 0)
+    {
+        onFrameTimeout();
+    }
+}
+
+void OccView::onFrameTimeout( void )
+{
+    if (!myIsDragPending && myWheelSteps == 0)
+    {
+        // Idle, the timer runs again with the next event and the
+        // statistics start over.
+        myFrameTimer->stop();
+        if (myIsRedrawPending)
+        {
+            myIsRedrawPending = false;
+            myView->Redraw();
+        }
+        myNbFrames = 0;
+        myFrameTimeSum = 0;
+        myFrameTimeMax = 0;
+        return;
+    }
+
+    const qint64 aStart = myClock.nsecsElapsed();
+
+    // Rotation, Pan and Zoom would each redraw the view.
+    const Standard_Boolean wasImmediate = myView->SetImmediateUpdate(Standard_False);
+
+    if (myIsDragPending)
+    {
+        myIsDragPending = false;
+
+        const int x = myDragPoint.x();
+        const int y = myDragPoint.y();
+
+        // Left button.
+        if (myDragFlags & Qt::LeftButton)
+        {
+            switch (myCurrentMode)
+            {
+            case CurAction3d_DynamicRotation:
+                myView->Rotation(x, y);
+                break;
+
+            case CurAction3d_DynamicZooming:
+                myView->Zoom(myXmax, myYmax, x, y);
+                myXmax = x;
+                myYmax = y;
+                break;
+
+            case CurAction3d_DynamicPanning:
+                myView->Pan(x - myXmax, myYmax - y);
+                myXmax = x;
+                myYmax = y;
+                break;
+
+             default:
+                break;
+            }
+        }
+        // Right button
+        else if (myDragFlags & Qt::RightButton)
+        {
+            switch (myCurrentMode)
+            {
+            case CurAction3d_DynamicPanning:
+                myView->Pan(x - myXmax, myYmax - y);
+                myXmax = x;
+                myYmax = y;
+                break;
+
+             default:
+                break;
+            }
+        }
+    }
+
+    if (myWheelSteps != 0)
+    {
+        const Standard_Integer aFactor = 16 * myWheelSteps;
+        myView->Zoom(myWheelPoint.x(), myWheelPoint.y(), myWheelPoint.x() + aFactor, myWheelPoint.y() + aFactor);
+        myWheelSteps = 0;
+    }
+
+    myView->SetImmediateUpdate(wasImmediate);
+    myView->Redraw();
+    myIsRedrawPending = false;
+
+    const qint64 anEnd = myClock.nsecsElapsed();
+    const qint64 aFrameTime = anEnd - aStart;
+
+    // Too slow to follow the mouse, the next frames are drawn coarse.
+    if (myIsLodEnabled && !myIsLodActive && aFrameTime > myLodFrameTime &&
+        (myDragFlags & (Qt::LeftButton | Qt::RightButton)) && QApplication::mouseButtons() != Qt::NoButton)
+    {
+        enterLod();
+    }
+
+    if (myNbFrames == 0)
+    {
+        myFrameWindowStart = aStart;
+    }
+    ++myNbFrames;
+    myFrameTimeSum += aFrameTime;
+    myFrameTimeMax = qMax(myFrameTimeMax, aFrameTime);
+
+    const qint64 aWindow = anEnd - myFrameWindowStart;
+    if (aWindow >= 1000000000)
+    {
+        emit frameStatistics(myNbFrames * 1.0e9 / aWindow, myFrameTimeSum * 1.0e-6 / myNbFrames, myFrameTimeMax * 1.0e-6);
+
+        myNbFrames = 0;
+        myFrameTimeSum = 0;
+        myFrameTimeMax = 0;
+    }
+}
+
+void OccView::prepareLod( const Handle(AIS_Shape)& theShape )
+{
+    if (theShape.IsNull())
     {
-        switch (myCurrentMode)
+        return;
+    }
+
+    LodEntry& aLod = myLodEntries[theShape.get()];
+    if (aLod.Shape.IsNull())
+    {
+        aLod.Shape = theShape;
+        aLod.NbTriangles = 0;
+        aLod.IsShown = false;
+        aLod.IsBuilding = false;
+        aLod.Generation = 0;
+    }
+
+    // A changed shape needs a new proxy.
+    if (!aLod.Source.IsEqual(theShape->Shape()))
+    {
+        if (!aLod.Proxy.IsNull())
         {
-        case CurAction3d_DynamicRotation:
-            myView->Rotation(thePoint.x(), thePoint.y());
-            break;
-
-        case CurAction3d_DynamicZooming:
-            myView->Zoom(myXmin, myYmin, thePoint.x(), thePoint.y());
-            break;
-
-        case CurAction3d_DynamicPanning:
-            myView->Pan(thePoint.x() - myXmax, myYmax - thePoint.y());
-            myXmax = thePoint.x();
-            myYmax = thePoint.y();
-            break;
-
-         default:
-            break;
+            myContext->Remove(aLod.Proxy, Standard_False);
+            aLod.Proxy.Nullify();
         }
+        aLod.Source = theShape->Shape();
+        aLod.IsShown = false;
+        aLod.IsBuilding = false;
+        aLod.Generation = ++myLodGeneration;
     }
 
-    // Right button
-    if (theFlags & Qt::RightButton)
+    // The count is taken again, the mesh may have been done since the last call.
+    aLod.NbTriangles = 0;
+    for (TopExp_Explorer anExp(aLod.Source, TopAbs_FACE); anExp.More(); anExp.Next())
     {
-        switch (myCurrentMode)
+        TopLoc_Location aLoc;
+        const Handle(Poly_Triangulation)& aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(anExp.Current()), aLoc);
+        if (!aTriangulation.IsNull())
         {
-        case CurAction3d_DynamicPanning:
-            myView->Pan(thePoint.x() - myXmax, myYmax - thePoint.y());
-            myXmax = thePoint.x();
-            myYmax = thePoint.y();
-            break;
-
-         default:
-            break;
+            aLod.NbTriangles += aTriangulation->NbTriangles();
         }
     }
 
+    // Mesh only faces of stl imports have no surface to mesh coarser.
+    if (aLod.NbTriangles < myLodMinTriangles || !aLod.Proxy.IsNull() || aLod.IsBuilding ||
+        StlReader::IsMeshOnly(aLod.Source))
+    {
+        return;
+    }
+
+    // The coarse mesh is made on a copy that shares the geometry, so the
+    // triangulation of the shape itself is kept. The topology is copied
+    // here, the worker must not walk faces the GUI thread may mesh.
+    BRepBuilderAPI_Copy aCopy(aLod.Source, Standard_False);
+    const TopoDS_Shape aCoarse = aCopy.Shape();
+    const double aCoefficient = myLodCoefficient;
+    const double anAngle = myLodAngle;
+
+    QFutureWatcher<TopoDS_Shape>* aWatcher = new QFutureWatcher<TopoDS_Shape>(this);
+    aWatcher->setProperty("lodShape", QVariant::fromValue((void*)theShape.get()));
+    aWatcher->setProperty("lodGeneration", aLod.Generation);
+    connect(aWatcher, SIGNAL(finished()), this, SLOT(onLodBuilt()));
+
+    aLod.IsBuilding = true;
+    aWatcher->setFuture(QtConcurrent::run([aCoarse, aCoefficient, anAngle]() -> TopoDS_Shape
+    {
+        // a triangulation taken over by the copy would be kept by BRepMesh.
+        BRepTools::Clean(aCoarse);
+
+        Bnd_Box aBox;
+        BRepBndLib::Add(aCoarse, aBox, Standard_False);
+        if (aBox.IsVoid())
+        {
+            return TopoDS_Shape();
+        }
+
+        BRepMesh_IncrementalMesh aMesher(aCoarse, aCoefficient * sqrt(aBox.SquareExtent()), Standard_False, anAngle, Standard_True);
+        return aCoarse;
+    }));
+}
+
+void OccView::onLodBuilt( void )
+{
+    QFutureWatcher<TopoDS_Shape>* aWatcher = dynamic_cast<QFutureWatcher<TopoDS_Shape>*>(sender());
+    if (aWatcher == NULL)
+    {
+        return;
+    }
+    aWatcher->deleteLater();
+
+    std::map<const AIS_InteractiveObject*, LodEntry>::iterator anEntry =
+        myLodEntries.find((const AIS_InteractiveObject*)aWatcher->property("lodShape").value<void*>());
+    if (anEntry == myLodEntries.end() || anEntry->second.Generation != aWatcher->property("lodGeneration").toInt())
+    {
+        return;
+    }
+
+    LodEntry& aLod = anEntry->second;
+    aLod.IsBuilding = false;
+
+    const TopoDS_Shape aCoarse = aWatcher->result();
+    if (aCoarse.IsNull())
+    {
+        return;
+    }
+
+    aLod.Proxy = new AIS_Shape(aCoarse);
+    aLod.Proxy->Attributes()->SetAutoTriangulation(Standard_False);
+    if (aLod.Shape->HasColor())
+    {
+        Quantity_Color aColor;
+        aLod.Shape->Color(aColor);
+        aLod.Proxy->SetColor(aColor);
+    }
+    aLod.Proxy->SetTransparency(aLod.Shape->Transparency());
+
+    // The presentation is computed now, not in the middle of a drag. The
+    // proxy is not selectable, its selection is never computed.
+    const Standard_Integer aMode = aLod.Shape->HasDisplayMode() ? aLod.Shape->DisplayMode() : myContext->DisplayMode();
+    myContext->Display(aLod.Proxy, aMode, -1, Standard_False);
+
+    if (myIsLodActive && myContext->IsDisplayed(aLod.Shape))
+    {
+        myContext->Erase(aLod.Shape, Standard_False);
+        aLod.IsShown = true;
+    }
+    else
+    {
+        myContext->Erase(aLod.Proxy, Standard_False);
+    }
+}
+
+void OccView::enterLod( void )
+{
+    // Only proxies built in advance are swapped in, nothing is computed here.
+    for (std::map<const AIS_InteractiveObject*, LodEntry>::iterator anEntry = myLodEntries.begin();
+         anEntry != myLodEntries.end(); ++anEntry)
+    {
+        LodEntry& aLod = anEntry->second;
+        if (aLod.Proxy.IsNull() || aLod.NbTriangles < myLodMinTriangles || !myContext->IsDisplayed(aLod.Shape) ||
+            !aLod.Source.IsEqual(aLod.Shape->Shape()))
+        {
+            continue;
+        }
+
+        const Standard_Integer aMode = aLod.Shape->HasDisplayMode() ? aLod.Shape->DisplayMode() : myContext->DisplayMode();
+
+        myContext->Erase(aLod.Shape, Standard_False);
+        myContext->Display(aLod.Proxy, aMode, -1, Standard_False);
+        aLod.IsShown = true;
+    }
+
+    myIsLodActive = true;
+}
+
+void OccView::leaveLod( void )
+{
+    if (!myIsLodActive)
+    {
+        return;
+    }
+    myIsLodActive = false;
+
+    std::map<const AIS_InteractiveObject*, LodEntry>::iterator anEntry = myLodEntries.begin();
+    while (anEntry != myLodEntries.end())
+    {
+        LodEntry& aLod = anEntry->second;
+        if (aLod.IsShown)
+        {
+            myContext->Erase(aLod.Proxy, Standard_False);
+            myContext->Display(aLod.Shape, Standard_False);
+            aLod.IsShown = false;
+        }
+
+        // Shapes removed from the viewer are forgotten, with their proxy.
+        if (!myContext->IsDisplayed(aLod.Shape))
+        {
+            if (!aLod.Proxy.IsNull())
+            {
+                myContext->Remove(aLod.Proxy, Standard_False);
+            }
+            anEntry = myLodEntries.erase(anEntry);
+        }
+        else
+        {
+            ++anEntry;
+        }
+    }
+
+    myContext->UpdateCurrentViewer();
 }
 
 void OccView::dragEvent( const int x, const int y )
@@ -721,12 +1143,65 @@ void OccView::multiInputEvent( const int x, const int y )
 
 void OccView::moveEvent( const int x, const int y )
 {
-    myContext->MoveTo(x, y, myView, Standard_True);
+    scheduleHover(x, y);
 }
 
 void OccView::multiMoveEvent( const int x, const int y )
 {
-    myContext->MoveTo(x, y, myView, Standard_True);
+    scheduleHover(x, y);
+}
+
+void OccView::scheduleHover( const int x, const int y )
+{
+    ++myNbHoverEvents;
+
+    // Only the last position of the frame is picked, the latency is
+    // counted from the first move that waits for it.
+    myHoverPoint = QPoint(x, y);
+    if (!myIsHoverPending)
+    {
+        myIsHoverPending = true;
+        myHoverEventTime = myClock.nsecsElapsed();
+    }
+
+    if (!myHoverTimer->isActive())
+    {
+        myHoverTimer->start();
+    }
+}
+
+void OccView::flushHover( void )
+{
+    if (myIsHoverPending)
+    {
+        myHoverTimer->stop();
+        onHoverTimeout();
+    }
+}
+
+void OccView::cancelHover( void )
+{
+    myHoverTimer->stop();
+    myIsHoverPending = false;
+}
+
+void OccView::onHoverTimeout( void )
+{
+    if (!myIsHoverPending)
+    {
+        return;
+    }
+    myIsHoverPending = false;
+
+    const qint64 aStart = myClock.nsecsElapsed();
+    myContext->MoveTo(myHoverPoint.x(), myHoverPoint.y(), myView, Standard_True);
+    const qint64 anEnd = myClock.nsecsElapsed();
+
+    const qint64 aLatency = anEnd - myHoverEventTime;
+    ++myNbHoverPicks;
+    myHoverPickTimeSum += anEnd - aStart;
+    myHoverLatencySum += aLatency;
+    myHoverLatencyMax = qMax(myHoverLatencyMax, aLatency);
 }
 
 void OccView::drawRubberBand( const int minX, const int minY, const int maxX, const int maxY )
@@ -755,6 +1230,8 @@ void OccView::drawRubberBand( const int minX, const int minY, const int maxX, co
 
 void OccView::panByLeftButton( const QPoint& thePoint )
 {
+    flushFrame();
+
     Standard_Integer aCenterX = 0;
     Standard_Integer aCenterY = 0;
 
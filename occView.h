@@ -12,7 +12,11 @@
 #ifndef _OCCVIEW_H_
 #define _OCCVIEW_H_
 
+#include <map>
+#include <vector>
+
 #include <QOpenGLWidget>
+#include <QElapsedTimer>
 
 #include <AIS_InteractiveContext.hxx>
 #include <AIS_Shape.hxx>
@@ -21,6 +25,7 @@
 #include <TopoDS_Vertex.hxx>
 
 class QMenu;
+class QTimer;
 class QRubberBand;
 class occDimensionDlg;
 
@@ -41,6 +46,23 @@ public:
         CurAction3d_DynamicRotation
     };
 
+    //! statistics of the hover highlighting, times in milliseconds.
+    struct HoverStatistics
+    {
+        //! mouse moves without a pressed button.
+        int NbEvents;
+
+        //! picks done, at most one per frame.
+        int NbPicks;
+
+        //! time from the first coalesced move to the end of its pick.
+        double MeanLatency;
+        double MaxLatency;
+
+        //! time of MoveTo, the pick and the redraw of the highlight.
+        double MeanPickTime;
+    };
+
 public:
     //! constructor.
     OccView(QWidget* parent);
@@ -48,9 +70,36 @@ public:
     const Handle(AIS_InteractiveContext)& getContext() const;
     const Handle(V3d_View)& getView() const;
 
+    //! mouse moves are picked at most once per theInterval milliseconds.
+    void setHoverInterval(int theInterval);
+
+    //! statistics of the hover highlighting since the last reset.
+    HoverStatistics hoverStatistics(void) const;
+    void resetHoverStatistics(void);
+
+    //! while the view is dragged and a frame takes longer than theFrameTime
+    //! milliseconds, shapes of at least theMinTriangles triangles are shown
+    //! with a coarse mesh until the mouse is released.
+    void setLodEnabled(bool isEnabled);
+    void setLodFrameTime(double theFrameTime);
+    void setLodMinTriangles(int theMinTriangles);
+
+    //! deflection of the coarse mesh, theCoefficient of the bounding box
+    //! diagonal and theAngle in radians.
+    void setLodDeflection(double theCoefficient, double theAngle);
+
+    //! count the triangles of a displayed shape and, if it is heavy, build
+    //! its coarse mesh on a worker thread. Called whenever the shape is
+    //! displayed or its mesh changes, drags only use finished proxies.
+    void prepareLod(const Handle(AIS_Shape)& theShape);
+
 signals:
     void selectionChanged(void);
 
+    //! frames per second and frame time in milliseconds, about once a
+    //! second while the view is rotated, panned or zoomed.
+    void frameStatistics(double theFps, double theMeanTime, double theMaxTime);
+
 public slots:
     //! operations for the view.
     void pan(void);
@@ -66,6 +115,16 @@ public slots:
     void radius(void);
     void diameter(void);
 
+protected slots:
+    //! pick the last mouse position of the frame.
+    void onHoverTimeout(void);
+
+    //! apply the view changes of the frame and redraw once.
+    void onFrameTimeout(void);
+
+    //! make the presentation of a finished coarse mesh.
+    void onLodBuilt(void);
+
 protected:
     virtual QPaintEngine* paintEngine() const;
 
@@ -99,6 +158,13 @@ protected:
     void inputEvent(const int x, const int y);
     void moveEvent(const int x, const int y);
     void multiMoveEvent(const int x, const int y);
+    void scheduleHover(const int x, const int y);
+    void flushHover(void);
+    void cancelHover(void);
+    void requestFrame(void);
+    void flushFrame(void);
+    void enterLod(void);
+    void leaveLod(void);
     void multiDragEvent(const int x, const int y);
     void multiInputEvent(const int x, const int y);
     void drawRubberBand(const int minX, const int minY, const int maxX, const int maxY);
@@ -130,6 +196,65 @@ private:
     //! rubber rectangle for the mouse selection.
     QRubberBand* myRectBand;
 
+    //! mouse moves waiting for the next hover pick.
+    QTimer* myHoverTimer;
+    QPoint myHoverPoint;
+    bool myIsHoverPending;
+    qint64 myHoverEventTime;
+
+    //! clock of the hover and frame timing.
+    QElapsedTimer myClock;
+
+    //! view changes waiting for the next frame.
+    QTimer* myFrameTimer;
+    QPoint myDragPoint;
+    int myDragFlags;
+    bool myIsDragPending;
+    int myWheelSteps;
+    QPoint myWheelPoint;
+
+    //! an expose event came while the frame timer ran.
+    bool myIsRedrawPending;
+
+    //! coarse presentation of a heavy shape, shown while the view is dragged.
+    struct LodEntry
+    {
+        Handle(AIS_Shape) Shape;
+        Handle(AIS_Shape) Proxy;
+        TopoDS_Shape Source;
+        int NbTriangles;
+        bool IsShown;
+
+        //! a coarse mesh is built, the generation tells stale results.
+        bool IsBuilding;
+        int Generation;
+    };
+
+    //! level of detail while dragging.
+    std::map<const AIS_InteractiveObject*, LodEntry> myLodEntries;
+    bool myIsLodEnabled;
+    bool myIsLodActive;
+    qint64 myLodFrameTime;
+    int myLodMinTriangles;
+    double myLodCoefficient;
+    double myLodAngle;
+
+    //! counts the coarse mesh builds, results of older builds are dropped.
+    int myLodGeneration;
+
+    //! frame statistics of the last second, times in nanoseconds.
+    int myNbFrames;
+    qint64 myFrameTimeSum;
+    qint64 myFrameTimeMax;
+    qint64 myFrameWindowStart;
+
+    //! hover statistics, times in nanoseconds.
+    int myNbHoverEvents;
+    int myNbHoverPicks;
+    qint64 myHoverLatencySum;
+    qint64 myHoverLatencyMax;
+    qint64 myHoverPickTimeSum;
+
 private:
     short myDimensionCounter = 0;
     TopoDS_Vertex myFirstVertex;
@@ -0,0 +1,171 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : occWriter.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Write shapes to CAD files.
+*/
+
+#include "occWriter.h"
+
+#include <mutex>
+
+#include <QFileInfo>
+#include <QTextCodec>
+
+#include <OSD_Timer.hxx>
+#include <TopoDS_Compound.hxx>
+#include <BRep_Builder.hxx>
+#include <BRepTools.hxx>
+
+#include <Interface_Static.hxx>
+#include <IGESControl_Writer.hxx>
+#include <IGESControl_Controller.hxx>
+#include <STEPControl_Writer.hxx>
+
+#include <dxfWriter.h>
+#include <stlWriter.h>
+#include <stepReader.h>
+
+occWriter::occWriter(const occWriteOptions& theOptions) : myOptions(theOptions),
+    myNbTriangles(0),
+    myMeshTime(0.0),
+    myWriteTime(0.0)
+{
+}
+
+bool occWriter::isSupported(const QString& theFileName)
+{
+    const QString aSuffix = QFileInfo(theFileName).suffix().toLower();
+    return aSuffix == "brep" || aSuffix == "igs" || aSuffix == "iges" || aSuffix == "stp" ||
+        aSuffix == "step" || aSuffix == "stl" || aSuffix == "dxf";
+}
+
+bool occWriter::write(const QString& theFileName, const Handle(TopTools_HSequenceOfShape)& theShapes)
+{
+    myNbTriangles = 0;
+    myMeshTime = 0.0;
+    myWriteTime = 0.0;
+
+    if (theShapes.IsNull() || theShapes->IsEmpty())
+        return false;
+
+    QFileInfo Info(theFileName);
+    QString aSuffix = Info.suffix().toLower();
+    QTextCodec *code = QTextCodec::codecForName("GB2312");
+    std::string filename = code->fromUnicode(theFileName).data();
+
+    OSD_Timer aTimer;
+    aTimer.Start();
+
+    bool isDone = false;
+
+    //brep
+    if (aSuffix == "brep")
+    {
+        // a single shape is written as it is.
+        TopoDS_Shape aShape = theShapes->Value(1);
+        if (theShapes->Length() > 1)
+        {
+            TopoDS_Compound aCompound;
+            BRep_Builder aBuilder;
+            aBuilder.MakeCompound(aCompound);
+            for (int i = 1; i <= theShapes->Length(); i++)
+            {
+                aBuilder.Add(aCompound, theShapes->Value(i));
+            }
+            aShape = aCompound;
+        }
+        isDone = BRepTools::Write(aShape, filename.c_str()) == Standard_True;
+    }
+    //igs
+    else if (aSuffix == "igs" || aSuffix == "iges")
+    {
+        // the controller registers itself globally, once for all threads.
+        static std::once_flag anIgesInit;
+        std::call_once(anIgesInit, []() { IGESControl_Controller::Init(); });
+
+        // the translators share global unit factors with the readers.
+        std::lock_guard<std::mutex> aLock(StepReader::TranslatorMutex());
+
+        IGESControl_Writer writer(Interface_Static::CVal("XSTEP.iges.unit"),
+                                  Interface_Static::IVal("XSTEP.iges.writebrep.mode"));
+
+        for (int i = 1; i <= theShapes->Length(); i++)
+        {
+            writer.AddShape(theShapes->Value(i));
+        }
+        writer.ComputeModel();
+        isDone = writer.Write(filename.c_str()) == Standard_True;
+    }
+    //stp
+    else if (aSuffix == "stp" || aSuffix == "step")
+    {
+        std::lock_guard<std::mutex> aLock(StepReader::TranslatorMutex());
+
+        STEPControl_Writer writer;
+        isDone = true;
+        for (int i = 1; i <= theShapes->Length() && isDone; i++)
+        {
+            isDone = writer.Transfer(theShapes->Value(i), STEPControl_AsIs) == IFSelect_RetDone;
+        }
+        isDone = isDone && writer.Write(filename.c_str()) == IFSelect_RetDone;
+    }
+    //stl
+    else if (aSuffix == "stl")
+    {
+        TopoDS_Compound res;
+        BRep_Builder builder;
+        builder.MakeCompound(res);
+        for (int i = 1; i <= theShapes->Length(); i++)
+        {
+            builder.Add(res, theShapes->Value(i));
+        }
+
+        StlWriter writer(myOptions.StlDeflection, myOptions.StlAngle);
+        isDone = writer.Write(res, filename, !myOptions.IsMeshed);
+
+        myNbTriangles = writer.NbTriangles();
+        myMeshTime = writer.MeshTime();
+    }
+    //dxf
+    else if (aSuffix == "dxf")
+    {
+        DxfWriter writer(filename);
+        if (writer.IsOpen())
+        {
+            for (int i = 1; i <= theShapes->Length(); i++)
+            {
+                if (myOptions.IsOutline)
+                    writer.AddOutline(theShapes->Value(i), myOptions.OutlineView);
+                else
+                    writer.AddShape(theShapes->Value(i));
+            }
+            writer.Close();
+            isDone = true;
+        }
+    }
+
+    aTimer.Stop();
+    myWriteTime = aTimer.ElapsedTime() - myMeshTime;
+
+    return isDone;
+}
+
+int occWriter::nbTriangles(void) const
+{
+    return myNbTriangles;
+}
+
+double occWriter::meshTime(void) const
+{
+    return myMeshTime;
+}
+
+double occWriter::writeTime(void) const
+{
+    return myWriteTime;
+}
@@ -0,0 +1,72 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : occWriter.h
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Write shapes to CAD files.
+*/
+
+#ifndef OCCWRITER_H
+#define OCCWRITER_H
+
+#include <QString>
+
+#include <gp_Ax2.hxx>
+#include <TopTools_HSequenceOfShape.hxx>
+
+//! settings of an export.
+struct occWriteOptions
+{
+    occWriteOptions(void) : StlDeflection(0.0), StlAngle(0.5), IsMeshed(false), IsOutline(false) {}
+
+    //! linear deflection of stl files, 0 for 0.1% of the bounding box diagonal.
+    double StlDeflection;
+
+    //! angular deflection of stl files in radians.
+    double StlAngle;
+
+    //! the faces are already meshed, stl files are written from their triangulation.
+    bool IsMeshed;
+
+    //! dxf files get the visible outline in OutlineView instead of the edges.
+    bool IsOutline;
+    gp_Ax2 OutlineView;
+};
+
+//! Write shapes to brep, iges, step, stl and dxf files. It does not need
+//! a window, so the GUI and the batch converter share it.
+class occWriter
+{
+public:
+    //! constructor.
+    occWriter(const occWriteOptions& theOptions = occWriteOptions());
+
+    //! the suffix of the file name is a format that can be written.
+    static bool isSupported(const QString& theFileName);
+
+    //! write the shapes, the format is chosen by the suffix.
+    //! @return false if there is nothing to write or the file could not be written.
+    bool write(const QString& theFileName, const Handle(TopTools_HSequenceOfShape)& theShapes);
+
+    //! number of triangles of the last stl export.
+    int nbTriangles(void) const;
+
+    //! time of meshing of the last stl export, in seconds.
+    double meshTime(void) const;
+
+    //! time of writing the last file, in seconds.
+    double writeTime(void) const;
+
+private:
+    occWriteOptions myOptions;
+
+    int myNbTriangles;
+
+    double myMeshTime;
+    double myWriteTime;
+};
+
+#endif // OCCWRITER_H
@@ -0,0 +1,224 @@
+#include "stepReader.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <OSD_Timer.hxx>
+#include <Message.hxx>
+#include <Message_Messenger.hxx>
+#include <Standard_Failure.hxx>
+
+#include <TopoDS_Compound.hxx>
+#include <BRep_Builder.hxx>
+
+StepReader::StepReader(const std::string& fileName, int theNbThreads,
+    const Handle(Message_ProgressIndicator)& theProgress) : m_FileName(fileName),
+    m_Progress(theProgress),
+    m_IsDone(false),
+    m_NbRoots(0),
+    m_NbThreads(0),
+    m_ElapsedTime(0.0),
+    m_ParseTime(0.0),
+    m_RootsTime(0.0),
+    m_NextRoot(0),
+    m_DoneRoots(0),
+    m_IsStopped(false)
+{
+#if !STEPREADER_PARALLEL_TRANSFER
+    // the parser and the unit factors are global, one file at a time.
+    std::lock_guard<std::mutex> aLock(TranslatorMutex());
+    theNbThreads = 1;
+#endif
+
+    OSD_Timer aTimer;
+    aTimer.Start();
+
+    // the first reader also initializes the static step controller before
+    // any other thread creates one.
+    STEPControl_Reader aReader;
+    if (aReader.ReadFile(m_FileName.c_str()) != IFSelect_RetDone)
+    {
+        return;
+    }
+    m_ParseTime = aTimer.ElapsedTime();
+
+    m_NbRoots = aReader.NbRootsForTransfer();
+    m_RootShapes.resize(m_NbRoots);
+    m_RootTimes.resize(m_NbRoots, 0.0);
+
+    m_NbThreads = theNbThreads > 0 ? theNbThreads : (int)std::thread::hardware_concurrency();
+    m_NbThreads = std::max(1, std::min(m_NbThreads, m_NbRoots));
+
+    if (!m_Progress.IsNull())
+    {
+        m_Progress->SetRange(0.0, m_NbRoots);
+        m_Progress->SetValue(0.0);
+    }
+
+    std::vector<std::thread> aThreads;
+    for (int i = 1; i < m_NbThreads; ++i)
+    {
+        aThreads.push_back(std::thread(&StepReader::readAndTransferRoots, this));
+    }
+
+    transferRoots(aReader, true);
+
+    // keep reporting until the workers have finished their last roots.
+    while (!m_Progress.IsNull() && !m_IsStopped && m_DoneRoots < m_NbRoots && m_NbThreads > 1)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        showProgress();
+    }
+
+    for (size_t i = 0; i < aThreads.size(); ++i)
+    {
+        aThreads[i].join();
+    }
+
+    // the same result as OneShape(), in root order.
+    TopoDS_Compound aCompound;
+    BRep_Builder aBuilder;
+    aBuilder.MakeCompound(aCompound);
+
+    int aNbShapes = 0;
+    for (int i = 0; i < m_NbRoots; ++i)
+    {
+        for (size_t k = 0; k < m_RootShapes[i].size(); ++k)
+        {
+            m_Shape = m_RootShapes[i][k];
+            aBuilder.Add(aCompound, m_RootShapes[i][k]);
+            ++aNbShapes;
+        }
+        m_RootsTime += m_RootTimes[i];
+    }
+
+    if (aNbShapes != 1)
+    {
+        m_Shape = aCompound;
+    }
+
+    m_RootShapes.clear();
+
+    aTimer.Stop();
+    m_ElapsedTime = aTimer.ElapsedTime();
+    m_IsDone = !m_IsStopped;
+
+    // each worker parses the file again, that is part of the elapsed time.
+    char aMessage[256];
+    sprintf(aMessage, "STEP transfer of %d roots on %d threads: %.2f s, parse %.2f s x %d, roots %.2f s, speedup %.1f",
+        m_NbRoots, m_NbThreads, m_ElapsedTime, m_ParseTime, m_NbThreads, m_RootsTime,
+        m_ElapsedTime > 0.0 ? (m_ParseTime + m_RootsTime) / m_ElapsedTime : 1.0);
+    Message::DefaultMessenger()->Send(aMessage, Message_Info);
+}
+
+bool StepReader::IsDone(void) const
+{
+    return m_IsDone;
+}
+
+const TopoDS_Shape& StepReader::GetShape(void) const
+{
+    return m_Shape;
+}
+
+int StepReader::NbRoots(void) const
+{
+    return m_NbRoots;
+}
+
+int StepReader::NbThreads(void) const
+{
+    return m_NbThreads;
+}
+
+double StepReader::ElapsedTime(void) const
+{
+    return m_ElapsedTime;
+}
+
+double StepReader::ParseTime(void) const
+{
+    return m_ParseTime;
+}
+
+double StepReader::RootsTime(void) const
+{
+    return m_RootsTime;
+}
+
+std::mutex& StepReader::TranslatorMutex(void)
+{
+    static std::mutex aMutex;
+    return aMutex;
+}
+
+void StepReader::readAndTransferRoots(void)
+{
+    STEPControl_Reader aReader;
+    if (aReader.ReadFile(m_FileName.c_str()) != IFSelect_RetDone ||
+        aReader.NbRootsForTransfer() != m_NbRoots)
+    {
+        return;
+    }
+
+    transferRoots(aReader, false);
+}
+
+void StepReader::transferRoots(STEPControl_Reader& theReader, bool isMain)
+{
+    while (!m_IsStopped)
+    {
+        const int i = m_NextRoot++;
+        if (i >= m_NbRoots)
+        {
+            break;
+        }
+
+        OSD_Timer aTimer;
+        aTimer.Start();
+
+        const int aFirst = theReader.NbShapes() + 1;
+        try
+        {
+            theReader.TransferOneRoot(i + 1);
+        }
+        catch (Standard_Failure&)
+        {
+            // the root is skipped, as TransferRoots() does.
+        }
+
+        for (int k = aFirst; k <= theReader.NbShapes(); ++k)
+        {
+            m_RootShapes[i].push_back(theReader.Shape(k));
+        }
+
+        aTimer.Stop();
+        m_RootTimes[i] = aTimer.ElapsedTime();
+
+        ++m_DoneRoots;
+
+        // progress indicators are not thread safe, only the calling thread reports.
+        if (isMain)
+        {
+            showProgress();
+        }
+    }
+}
+
+void StepReader::showProgress(void)
+{
+    if (m_Progress.IsNull())
+    {
+        return;
+    }
+
+    m_Progress->SetValue(m_DoneRoots);
+    m_Progress->Show(Standard_False);
+    if (m_Progress->UserBreak())
+    {
+        m_IsStopped = true;
+    }
+}
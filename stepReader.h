@@ -0,0 +1,147 @@
+#ifndef STEPREADER_H
+#define STEPREADER_H
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+#include <Message_ProgressIndicator.hxx>
+#include <STEPControl_Reader.hxx>
+#include <Standard_Version.hxx>
+
+/**
+* Before OCCT 7.8 the StepFile parser keeps its state in globals and the
+* transfer writes the global length and angle factors of UnitsMethods, so
+* only one STEP or IGES file may be read and transferred at a time in the
+* process. From 7.8 on the factors belong to the model.
+*/
+#if OCC_VERSION_HEX >= 0x070800
+#define STEPREADER_PARALLEL_TRANSFER 1
+#else
+#define STEPREADER_PARALLEL_TRANSFER 0
+#endif
+
+/**
+* @breif Transfer the roots of a STEP file, on several threads where OCCT allows it.
+*
+* The file is parsed once by the calling thread. With parallel transfer,
+* every worker thread parses the file again into its own
+* STEPControl_Reader, so no model or transfer session is shared, and
+* then takes roots from a common counter. The shapes are collected into
+* one compound in root order, as STEPControl_Reader::OneShape() does.
+*
+* Roots are transferred independently, sub-shapes shared by several roots
+* are not shared in the result. Files with a single root, one thread, or
+* OCCT versions without parallel transfer are transferred sequentially by
+* one reader while TranslatorMutex() is held.
+*/
+class StepReader
+{
+public:
+    /**
+    * @brief constructor, reads and transfers the file.
+    * @param fileName [in] step file name with path.
+    * @param theNbThreads [in] number of threads, 0 for one per core, 1 without parallel transfer.
+    * @param theProgress [in] optional progress, updated and polled on the calling thread only.
+    */
+    StepReader(const std::string& fileName, int theNbThreads = 0,
+        const Handle(Message_ProgressIndicator)& theProgress = NULL);
+
+    /**
+    * @brief Check whether the file could be read.
+    */
+    bool IsDone(void) const;
+
+    /**
+    * @brief Get the shape of the step file.
+    * @return compound of the shapes of all roots, or the only shape.
+    */
+    const TopoDS_Shape& GetShape(void) const;
+
+    /**
+    * @brief Get the number of transferred roots.
+    */
+    int NbRoots(void) const;
+
+    /**
+    * @brief Get the number of threads used for the transfer.
+    */
+    int NbThreads(void) const;
+
+    /**
+    * @brief Get the wall clock time of reading and transferring, in seconds.
+    */
+    double ElapsedTime(void) const;
+
+    /**
+    * @brief Get the time of parsing the file once, in seconds.
+    *
+    * Every worker thread of a parallel transfer parses the file again.
+    */
+    double ParseTime(void) const;
+
+    /**
+    * @brief Lock held while a STEP or IGES file is read and transferred,
+    * for OCCT versions whose translators use global state.
+    */
+    static std::mutex& TranslatorMutex(void);
+
+    /**
+    * @brief Get the sum of the transfer times of all roots, in seconds.
+    *
+    * That is about the time of a sequential transfer, compared with
+    * ElapsedTime() it gives the speedup of the parallel transfer.
+    */
+    double RootsTime(void) const;
+
+private:
+    /**
+    * @brief Transfer roots taken from the counter with one reader.
+    * @param theReader [in] reader with the file read and the roots counted.
+    * @param isMain [in] running on the calling thread, which owns the progress.
+    */
+    void transferRoots(STEPControl_Reader& theReader, bool isMain);
+
+    /**
+    * @brief Read the file into an own reader and transfer roots, for the worker threads.
+    */
+    void readAndTransferRoots(void);
+
+    /**
+    * @brief Report the transferred roots and check for cancel, on the calling thread.
+    */
+    void showProgress(void);
+
+private:
+    std::string m_FileName;
+
+    Handle(Message_ProgressIndicator) m_Progress;
+
+    bool m_IsDone;
+
+    TopoDS_Shape m_Shape;
+
+    int m_NbRoots;
+    int m_NbThreads;
+
+    double m_ElapsedTime;
+    double m_ParseTime;
+    double m_RootsTime;
+
+    // shapes and transfer time of every root.
+    std::vector<std::vector<TopoDS_Shape> > m_RootShapes;
+    std::vector<double> m_RootTimes;
+
+    // next root to transfer and number of transferred roots.
+    std::atomic<int> m_NextRoot;
+    std::atomic<int> m_DoneRoots;
+
+    // set when the transfer is canceled.
+    std::atomic<bool> m_IsStopped;
+};
+
+#endif // STEPREADER_H
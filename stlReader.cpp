@@ -0,0 +1,354 @@
+#include "stlReader.h"
+
+#include <string.h>
+#include <ctype.h>
+
+#include <algorithm>
+
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopExp_Explorer.hxx>
+#include <BRep_Tool.hxx>
+#include <BRep_Builder.hxx>
+#include <TColgp_Array1OfPnt.hxx>
+#include <Poly_Array1OfTriangle.hxx>
+
+#include "dl_dxf.h"
+#include "dl_mappedfile.h"
+
+// binary stl: 80 byte header, triangle count, 50 bytes per triangle.
+static const size_t THE_HEADER_SIZE = 84;
+static const size_t THE_TRIANGLE_SIZE = 50;
+
+/**
+* @brief Bits of a float, with -0 and +0 the same.
+*/
+static uint32_t floatBits(float theValue)
+{
+    theValue += 0.0f;
+
+    uint32_t aBits;
+    memcpy(&aBits, &theValue, sizeof(aBits));
+    return aBits;
+}
+
+/**
+* @brief Hash of the bits of a vertex.
+*/
+static uint32_t hashNode(const float* theCoord)
+{
+    // float bits of grid like coordinates differ in few bits, mix them well.
+    uint32_t aHash = floatBits(theCoord[0]);
+    aHash = (aHash ^ (aHash >> 16)) * 0x85ebca6bu + floatBits(theCoord[1]);
+    aHash = (aHash ^ (aHash >> 13)) * 0xc2b2ae35u + floatBits(theCoord[2]);
+    aHash = (aHash ^ (aHash >> 16)) * 0x85ebca6bu;
+    return aHash ^ (aHash >> 13);
+}
+
+/**
+* @brief Read a little endian float of a binary stl.
+*/
+static float getFloat(const char* theData)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(theData);
+    const uint32_t aBits = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+
+    float aValue;
+    memcpy(&aValue, &aBits, sizeof(aValue));
+    return aValue;
+}
+
+/**
+* @brief Read the triangle count of a binary stl header.
+*/
+static size_t getNbTriangles(const char* theData)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(theData + 80);
+    return (size_t)p[0] | ((size_t)p[1] << 8) | ((size_t)p[2] << 16) | ((size_t)p[3] << 24);
+}
+
+/**
+* @brief Check whether the text after the "solid" line is a facet or the end of an ascii stl.
+*/
+static bool isAscii(const char* theData, size_t theSize)
+{
+    const char* p = theData;
+    const char* anEnd = theData + theSize;
+    while (p < anEnd && isspace((unsigned char)*p))
+    {
+        ++p;
+    }
+    if (anEnd - p < 5 || strncmp(p, "solid", 5) != 0)
+    {
+        return false;
+    }
+
+    // the name of the solid may be anything, the next line decides.
+    while (p < anEnd && *p != '\n' && *p != '\r')
+    {
+        ++p;
+    }
+    while (p < anEnd && isspace((unsigned char)*p))
+    {
+        ++p;
+    }
+    return (anEnd - p >= 5 && strncmp(p, "facet", 5) == 0) ||
+        (anEnd - p >= 8 && strncmp(p, "endsolid", 8) == 0);
+}
+
+StlReader::StlReader(const std::string& fileName) : m_IsDone(false),
+    m_Mask(0)
+{
+    DL_MappedFile aFile;
+    if (!aFile.open(fileName) || aFile.data() == NULL)
+    {
+        return;
+    }
+
+    const char* aData = aFile.data();
+    const size_t aSize = aFile.size();
+
+    // binary files may start with "solid" as well, and may have padding
+    // after the triangles. A file large enough for its triangle count is
+    // binary unless its second line is ascii stl.
+    const bool isBinary = aSize >= THE_HEADER_SIZE &&
+        aSize >= THE_HEADER_SIZE + THE_TRIANGLE_SIZE * getNbTriangles(aData) &&
+        !isAscii(aData, aSize);
+
+    m_IsDone = isBinary ? readBinary(aData, aSize) : readAscii(aData, aSize);
+
+    // the table is only needed while reading.
+    std::vector<int>().swap(m_Table);
+
+    if (m_IsDone)
+    {
+        makeShape();
+    }
+}
+
+bool StlReader::IsDone(void) const
+{
+    return m_IsDone;
+}
+
+const TopoDS_Shape& StlReader::GetShape(void) const
+{
+    return m_Shape;
+}
+
+const Handle(Poly_Triangulation)& StlReader::GetTriangulation(void) const
+{
+    return m_Triangulation;
+}
+
+bool StlReader::IsMeshOnly(const TopoDS_Shape& theShape)
+{
+    bool hasFaces = false;
+    for (TopExp_Explorer anExp(theShape, TopAbs_FACE); anExp.More(); anExp.Next())
+    {
+        TopLoc_Location aLoc;
+        if (!BRep_Tool::Surface(TopoDS::Face(anExp.Current()), aLoc).IsNull())
+        {
+            return false;
+        }
+        hasFaces = true;
+    }
+    return hasFaces;
+}
+
+bool StlReader::readBinary(const char* theData, size_t theSize)
+{
+    // trailing bytes after the triangles are ignored.
+    const size_t aNbTriangles = std::min(getNbTriangles(theData), (theSize - THE_HEADER_SIZE) / THE_TRIANGLE_SIZE);
+
+    // closed meshes have about half as many vertices as triangles.
+    reserve(aNbTriangles / 2 + 16);
+    m_Triangles.reserve(3 * aNbTriangles);
+
+    float aCoords[9];
+    const char* p = theData + THE_HEADER_SIZE;
+    for (size_t i = 0; i < aNbTriangles; ++i, p += THE_TRIANGLE_SIZE)
+    {
+        // the normal is computed again from the triangle.
+        for (int k = 0; k < 9; ++k)
+        {
+            aCoords[k] = getFloat(p + 12 + 4 * k);
+        }
+        addTriangle(aCoords);
+    }
+
+    return true;
+}
+
+bool StlReader::readAscii(const char* theData, size_t theSize)
+{
+    // an ascii facet takes about 250 bytes.
+    reserve(theSize / 500 + 16);
+    m_Triangles.reserve(3 * (theSize / 250));
+
+    const char* p = theData;
+    const char* anEnd = theData + theSize;
+
+    float aCoords[9];
+    int aNbCoords = 0;
+
+    while (p < anEnd)
+    {
+        // next whitespace separated token.
+        while (p < anEnd && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+        {
+            ++p;
+        }
+        const char* aToken = p;
+        while (p < anEnd && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+        {
+            ++p;
+        }
+        const size_t aLength = p - aToken;
+
+        if (aLength != 6 || strncmp(aToken, "vertex", 6) != 0)
+        {
+            continue;
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            while (p < anEnd && (*p == ' ' || *p == '\t'))
+            {
+                ++p;
+            }
+            const char* aValue = p;
+            while (p < anEnd && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+            {
+                ++p;
+            }
+            aCoords[aNbCoords++] = (float)DL_Dxf::toReal(aValue, p - aValue);
+        }
+
+        if (aNbCoords == 9)
+        {
+            addTriangle(aCoords);
+            aNbCoords = 0;
+        }
+    }
+
+    return !m_Triangles.empty();
+}
+
+void StlReader::addTriangle(const float* theCoords)
+{
+    const int n1 = addNode(theCoords);
+    const int n2 = addNode(theCoords + 3);
+    const int n3 = addNode(theCoords + 6);
+
+    if (n1 == n2 || n2 == n3 || n3 == n1)
+    {
+        return;
+    }
+
+    m_Triangles.push_back(n1);
+    m_Triangles.push_back(n2);
+    m_Triangles.push_back(n3);
+}
+
+int StlReader::addNode(const float* theCoord)
+{
+    const uint32_t x = floatBits(theCoord[0]);
+    const uint32_t y = floatBits(theCoord[1]);
+    const uint32_t z = floatBits(theCoord[2]);
+
+    uint32_t aSlot = hashNode(theCoord) & m_Mask;
+    for (;;)
+    {
+        const int aNode = m_Table[aSlot];
+        if (aNode < 0)
+        {
+            break;
+        }
+
+        const float* aCoord = &m_Nodes[3 * aNode];
+        if (floatBits(aCoord[0]) == x && floatBits(aCoord[1]) == y && floatBits(aCoord[2]) == z)
+        {
+            return aNode;
+        }
+        aSlot = (aSlot + 1) & m_Mask;
+    }
+
+    const int aNode = (int)(m_Nodes.size() / 3);
+    m_Nodes.push_back(theCoord[0]);
+    m_Nodes.push_back(theCoord[1]);
+    m_Nodes.push_back(theCoord[2]);
+    m_Table[aSlot] = aNode;
+
+    // keep the table at most half full.
+    if (2 * (size_t)(aNode + 1) > m_Table.size())
+    {
+        reserve(2 * (size_t)(aNode + 1));
+    }
+
+    return aNode;
+}
+
+void StlReader::reserve(size_t theNbNodes)
+{
+    size_t aSize = 16;
+    while (aSize < 2 * theNbNodes)
+    {
+        aSize <<= 1;
+    }
+    if (aSize <= m_Table.size())
+    {
+        return;
+    }
+
+    m_Nodes.reserve(3 * theNbNodes);
+
+    m_Table.assign(aSize, -1);
+    m_Mask = (uint32_t)(aSize - 1);
+
+    const int aNbNodes = (int)(m_Nodes.size() / 3);
+    for (int i = 0; i < aNbNodes; ++i)
+    {
+        uint32_t aSlot = hashNode(&m_Nodes[3 * i]) & m_Mask;
+        while (m_Table[aSlot] >= 0)
+        {
+            aSlot = (aSlot + 1) & m_Mask;
+        }
+        m_Table[aSlot] = i;
+    }
+}
+
+void StlReader::makeShape(void)
+{
+    const int aNbNodes = (int)(m_Nodes.size() / 3);
+    const int aNbTriangles = (int)(m_Triangles.size() / 3);
+    if (aNbTriangles == 0)
+    {
+        m_IsDone = false;
+        return;
+    }
+
+    m_Triangulation = new Poly_Triangulation(aNbNodes, aNbTriangles, Standard_False);
+
+    TColgp_Array1OfPnt& aNodes = m_Triangulation->ChangeNodes();
+    for (int i = 0; i < aNbNodes; ++i)
+    {
+        const float* aCoord = &m_Nodes[3 * i];
+        aNodes.SetValue(i + 1, gp_Pnt(aCoord[0], aCoord[1], aCoord[2]));
+    }
+    std::vector<float>().swap(m_Nodes);
+
+    Poly_Array1OfTriangle& aTriangles = m_Triangulation->ChangeTriangles();
+    for (int i = 0; i < aNbTriangles; ++i)
+    {
+        const int* aTriangle = &m_Triangles[3 * i];
+        aTriangles.SetValue(i + 1, Poly_Triangle(aTriangle[0] + 1, aTriangle[1] + 1, aTriangle[2] + 1));
+    }
+    std::vector<int>().swap(m_Triangles);
+
+    TopoDS_Face aFace;
+    BRep_Builder aBuilder;
+    aBuilder.MakeFace(aFace, m_Triangulation);
+
+    m_Shape = aFace;
+}
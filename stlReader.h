@@ -0,0 +1,107 @@
+#ifndef STLREADER_H
+#define STLREADER_H
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+#include <Poly_Triangulation.hxx>
+
+/**
+* @breif Read binary and ASCII STL files into one triangulation.
+*
+* The file is memory mapped and the triangles are read in place. Equal
+* vertices are merged through an open addressing hash of their float
+* coordinates, so the mesh keeps every vertex once instead of three times
+* per triangle. The result is a single face carrying the Poly_Triangulation,
+* not one face per triangle as StlAPI_Reader makes.
+*
+* The face is mesh only: it has no surface, no wire and no edges. It is
+* drawn only in shaded mode, its bounding box and selection come from the
+* triangulation, and it must not be given to BRepMesh, which would need
+* the surface. See IsMeshOnly().
+*/
+class StlReader
+{
+public:
+    /**
+    * @brief constructor, reads the file.
+    * @param fileName [in] stl file name with path.
+    */
+    StlReader(const std::string& fileName);
+
+    /**
+    * @brief Check whether the file could be read.
+    */
+    bool IsDone(void) const;
+
+    /**
+    * @brief Get the shape of the stl, a face with the triangulation.
+    */
+    const TopoDS_Shape& GetShape(void) const;
+
+    /**
+    * @brief Get the triangulation with the merged vertices.
+    */
+    const Handle(Poly_Triangulation)& GetTriangulation(void) const;
+
+    /**
+    * @brief Check whether all faces of a shape are mesh only, i.e. carry a
+    * triangulation but no surface, as the faces made by this reader.
+    * @return false for shapes without faces.
+    */
+    static bool IsMeshOnly(const TopoDS_Shape& theShape);
+
+private:
+    /**
+    * @brief Read the triangles of a binary stl.
+    */
+    bool readBinary(const char* theData, size_t theSize);
+
+    /**
+    * @brief Read the facets of an ASCII stl.
+    */
+    bool readAscii(const char* theData, size_t theSize);
+
+    /**
+    * @brief Add a triangle, skipped if two of its vertices are the same.
+    * @param theCoords [in] x, y, z of the three vertices.
+    */
+    void addTriangle(const float* theCoords);
+
+    /**
+    * @brief Get the index of a vertex, adding it if it is new.
+    */
+    int addNode(const float* theCoord);
+
+    /**
+    * @brief Make the hash table large enough for the given number of nodes.
+    */
+    void reserve(size_t theNbNodes);
+
+    /**
+    * @brief Copy the nodes and triangles into the Poly_Triangulation and make the face.
+    */
+    void makeShape(void);
+
+private:
+    bool m_IsDone;
+
+    TopoDS_Shape m_Shape;
+
+    Handle(Poly_Triangulation) m_Triangulation;
+
+    // merged vertices as float x, y, z and triangles as node indices.
+    std::vector<float> m_Nodes;
+    std::vector<int> m_Triangles;
+
+    // open addressing hash of the nodes, -1 for free slots.
+    std::vector<int> m_Table;
+    uint32_t m_Mask;
+};
+
+#endif // STLREADER_H
@@ -0,0 +1,244 @@
+#include "stlWriter.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <OSD_Timer.hxx>
+#include <Message.hxx>
+#include <Message_Messenger.hxx>
+
+#include <Bnd_Box.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopExp_Explorer.hxx>
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopoDS_Compound.hxx>
+#include <BRep_Builder.hxx>
+
+// size of the output buffer, about 20000 triangles.
+static const size_t THE_BUFFER_SIZE = 1 << 20;
+
+// binary stl: 80 byte header, triangle count, 50 bytes per triangle.
+static const size_t THE_HEADER_SIZE = 84;
+static const size_t THE_TRIANGLE_SIZE = 50;
+
+/**
+* @brief Write a float in little endian order.
+*/
+static char* putFloat(char* theBuffer, double theValue)
+{
+    const float aValue = (float)theValue;
+
+    uint32_t aBits;
+    memcpy(&aBits, &aValue, sizeof(aBits));
+    theBuffer[0] = (char)(aBits & 0xff);
+    theBuffer[1] = (char)((aBits >> 8) & 0xff);
+    theBuffer[2] = (char)((aBits >> 16) & 0xff);
+    theBuffer[3] = (char)((aBits >> 24) & 0xff);
+    return theBuffer + 4;
+}
+
+StlWriter::StlWriter(double theLinDeflection, double theAngDeflection) : m_LinDeflection(theLinDeflection),
+    m_AngDeflection(theAngDeflection),
+    m_NbTriangles(0),
+    m_MeshTime(0.0),
+    m_WriteTime(0.0)
+{
+}
+
+bool StlWriter::Write(const TopoDS_Shape& theShape, const std::string& fileName, bool toMesh)
+{
+    m_NbTriangles = 0;
+    m_MeshTime = 0.0;
+    m_WriteTime = 0.0;
+
+    if (theShape.IsNull())
+    {
+        return false;
+    }
+
+    OSD_Timer aTimer;
+    aTimer.Start();
+
+    double aDeflection = m_LinDeflection;
+    if (toMesh && aDeflection <= 0.0)
+    {
+        Bnd_Box aBox;
+        BRepBndLib::Add(theShape, aBox);
+        if (aBox.IsVoid())
+        {
+            return false;
+        }
+        aDeflection = 0.001 * sqrt(aBox.SquareExtent());
+    }
+
+    // faces are meshed on all cores, mesh only faces of stl imports keep
+    // their triangulation, there is no surface to mesh.
+    if (toMesh)
+    {
+        TopoDS_Compound aFaces;
+        BRep_Builder aBuilder;
+        aBuilder.MakeCompound(aFaces);
+
+        bool hasFaces = false;
+        for (TopExp_Explorer anExp(theShape, TopAbs_FACE); anExp.More(); anExp.Next())
+        {
+            TopLoc_Location aLoc;
+            if (!BRep_Tool::Surface(TopoDS::Face(anExp.Current()), aLoc).IsNull())
+            {
+                aBuilder.Add(aFaces, anExp.Current());
+                hasFaces = true;
+            }
+        }
+
+        if (hasFaces)
+        {
+            BRepMesh_IncrementalMesh aMesher(aFaces, aDeflection, Standard_False, m_AngDeflection, Standard_True);
+        }
+    }
+
+    aTimer.Stop();
+    m_MeshTime = aTimer.ElapsedTime();
+    aTimer.Reset();
+    aTimer.Start();
+
+    // the count is in the header, so it is taken first.
+    size_t aNbTriangles = 0;
+    for (TopExp_Explorer anExp(theShape, TopAbs_FACE); anExp.More(); anExp.Next())
+    {
+        TopLoc_Location aLoc;
+        const Handle(Poly_Triangulation)& aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(anExp.Current()), aLoc);
+        if (!aTriangulation.IsNull())
+        {
+            aNbTriangles += aTriangulation->NbTriangles();
+        }
+    }
+
+    FILE* aFile = fopen(fileName.c_str(), "wb");
+    if (aFile == NULL)
+    {
+        return false;
+    }
+
+    std::vector<char> aBuffer(THE_BUFFER_SIZE);
+    char* p = &aBuffer[0];
+    char* const aLimit = &aBuffer[0] + THE_BUFFER_SIZE - THE_TRIANGLE_SIZE;
+
+    memset(p, ' ', 80);
+    memcpy(p, "occQt", 5);
+    const uint32_t aCount = (uint32_t)aNbTriangles;
+    p[80] = (char)(aCount & 0xff);
+    p[81] = (char)((aCount >> 8) & 0xff);
+    p[82] = (char)((aCount >> 16) & 0xff);
+    p[83] = (char)((aCount >> 24) & 0xff);
+    p += THE_HEADER_SIZE;
+
+    bool isDone = true;
+
+    for (TopExp_Explorer anExp(theShape, TopAbs_FACE); anExp.More(); anExp.Next())
+    {
+        const TopoDS_Face& aFace = TopoDS::Face(anExp.Current());
+
+        TopLoc_Location aLoc;
+        const Handle(Poly_Triangulation)& aTriangulation = BRep_Tool::Triangulation(aFace, aLoc);
+        if (aTriangulation.IsNull())
+        {
+            continue;
+        }
+
+        const gp_Trsf& aTrsf = aLoc.Transformation();
+        const bool isIdentity = aLoc.IsIdentity();
+        // a mirroring location turns the triangles inside out as well.
+        const bool isReversed = (aFace.Orientation() == TopAbs_REVERSED) != aTrsf.IsNegative();
+
+        const TColgp_Array1OfPnt& aNodes = aTriangulation->Nodes();
+        const Poly_Array1OfTriangle& aTriangles = aTriangulation->Triangles();
+
+        for (Standard_Integer i = aTriangles.Lower(); i <= aTriangles.Upper(); ++i)
+        {
+            Standard_Integer n1, n2, n3;
+            aTriangles(i).Get(n1, n2, n3);
+            if (isReversed)
+            {
+                std::swap(n2, n3);
+            }
+
+            gp_Pnt aP1 = aNodes(n1);
+            gp_Pnt aP2 = aNodes(n2);
+            gp_Pnt aP3 = aNodes(n3);
+            if (!isIdentity)
+            {
+                aP1.Transform(aTrsf);
+                aP2.Transform(aTrsf);
+                aP3.Transform(aTrsf);
+            }
+
+            gp_XYZ aNormal = (aP2.XYZ() - aP1.XYZ()).Crossed(aP3.XYZ() - aP1.XYZ());
+            const double aModulus = aNormal.Modulus();
+            if (aModulus > gp::Resolution())
+            {
+                aNormal /= aModulus;
+            }
+
+            p = putFloat(p, aNormal.X());
+            p = putFloat(p, aNormal.Y());
+            p = putFloat(p, aNormal.Z());
+            p = putFloat(p, aP1.X());
+            p = putFloat(p, aP1.Y());
+            p = putFloat(p, aP1.Z());
+            p = putFloat(p, aP2.X());
+            p = putFloat(p, aP2.Y());
+            p = putFloat(p, aP2.Z());
+            p = putFloat(p, aP3.X());
+            p = putFloat(p, aP3.Y());
+            p = putFloat(p, aP3.Z());
+            *p++ = 0;
+            *p++ = 0;
+
+            if (p > aLimit)
+            {
+                const size_t aSize = p - &aBuffer[0];
+                isDone = isDone && fwrite(&aBuffer[0], 1, aSize, aFile) == aSize;
+                p = &aBuffer[0];
+            }
+        }
+    }
+
+    const size_t aSize = p - &aBuffer[0];
+    isDone = isDone && fwrite(&aBuffer[0], 1, aSize, aFile) == aSize;
+    isDone = fclose(aFile) == 0 && isDone;
+
+    aTimer.Stop();
+    m_WriteTime = aTimer.ElapsedTime();
+    m_NbTriangles = (int)aNbTriangles;
+
+    const double aTotal = m_MeshTime + m_WriteTime;
+    char aMessage[256];
+    sprintf(aMessage, "STL export of %d triangles: mesh %.2f s, write %.2f s, %.0f triangles/s",
+        m_NbTriangles, m_MeshTime, m_WriteTime, aTotal > 0.0 ? m_NbTriangles / aTotal : 0.0);
+    Message::DefaultMessenger()->Send(aMessage, Message_Info);
+
+    return isDone;
+}
+
+int StlWriter::NbTriangles(void) const
+{
+    return m_NbTriangles;
+}
+
+double StlWriter::MeshTime(void) const
+{
+    return m_MeshTime;
+}
+
+double StlWriter::WriteTime(void) const
+{
+    return m_WriteTime;
+}
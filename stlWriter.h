@@ -0,0 +1,61 @@
+#ifndef STLWRITER_H
+#define STLWRITER_H
+
+#pragma once
+
+#include <string>
+
+#include <TopoDS_Shape.hxx>
+
+/**
+* @breif Mesh shapes in parallel and write them as binary STL.
+*
+* The faces are meshed by BRepMesh_IncrementalMesh in parallel mode with
+* the given deflections, then the triangles are written in one pass
+* through a large output buffer.
+*/
+class StlWriter
+{
+public:
+    /**
+    * @brief constructor.
+    * @param theLinDeflection [in] maximum chord deflection, 0 for 0.1% of the bounding box diagonal.
+    * @param theAngDeflection [in] maximum angle between neighbour triangles in radians.
+    */
+    StlWriter(double theLinDeflection = 0.0, double theAngDeflection = 0.5);
+
+    /**
+    * @brief Mesh the shape and write all triangles of its faces.
+    * @param theShape [in] shape to export.
+    * @param fileName [in] stl file name with path.
+    * @param toMesh [in] mesh the faces, false to write the triangulation they have.
+    * @return false if the file could not be written.
+    */
+    bool Write(const TopoDS_Shape& theShape, const std::string& fileName, bool toMesh = true);
+
+    /**
+    * @brief Get the number of triangles written.
+    */
+    int NbTriangles(void) const;
+
+    /**
+    * @brief Get the time of meshing, in seconds.
+    */
+    double MeshTime(void) const;
+
+    /**
+    * @brief Get the time of writing the file, in seconds.
+    */
+    double WriteTime(void) const;
+
+private:
+    double m_LinDeflection;
+    double m_AngDeflection;
+
+    int m_NbTriangles;
+
+    double m_MeshTime;
+    double m_WriteTime;
+};
+
+#endif // STLWRITER_H
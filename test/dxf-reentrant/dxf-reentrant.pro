@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Read one DXF file on several threads at once and
+# compare the results, needs neither Qt nor OCCT.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = dxf-reentrant
+TEMPLATE = app
+
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+SOURCES += main.cpp
+
+# dxflib
+include($$PWD/../../dxflib/dxflib.pri)
@@ -0,0 +1,206 @@
+/*
+*    Copyright (c) 2024 Tim Hong All Rights Reserved.
+*
+*           File : main.cpp
+*         Author : Tim Hong(hotize@163.com)
+*           Date : 2024-01-01 00:00
+*        Version : OpenCASCADE7.3.0 & Qt5.12.12
+*
+*    Description : Read the same DXF file on several threads at once and
+*                  compare every callback with a sequential read.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dl_dxf.h"
+#include "dl_creationadapter.h"
+
+//! writes every callback as one line of text, reals with all digits.
+class dxfLog : public DL_CreationAdapter
+{
+public:
+    virtual void addPoint(const DL_PointData& theData)
+    {
+        add("POINT", theData.x, theData.y, theData.z);
+    }
+
+    virtual void addLine(const DL_LineData& theData)
+    {
+        add("LINE", theData.x1, theData.y1, theData.z1);
+        add(" to", theData.x2, theData.y2, theData.z2);
+    }
+
+    virtual void addArc(const DL_ArcData& theData)
+    {
+        add("ARC", theData.cx, theData.cy, theData.radius);
+        add(" angles", theData.angle1, theData.angle2, 0.0);
+    }
+
+    virtual void addCircle(const DL_CircleData& theData)
+    {
+        add("CIRCLE", theData.cx, theData.cy, theData.radius);
+    }
+
+    virtual void addPolyline(const DL_PolylineData& theData)
+    {
+        add("POLYLINE", theData.number, theData.flags, theData.elevation);
+    }
+
+    virtual void addVertex(const DL_VertexData& theData)
+    {
+        add(" vertex", theData.x, theData.y, theData.bulge);
+    }
+
+    const std::string& text(void) const
+    {
+        return myText;
+    }
+
+private:
+    void add(const char* theName, double x, double y, double z)
+    {
+        char aLine[128];
+        snprintf(aLine, sizeof(aLine), "%s %s %.17g %.17g %.17g\n", theName, getAttributes().getLayer().c_str(), x, y, z);
+        myText += aLine;
+    }
+
+    std::string myText;
+};
+
+//! drawing with all entity kinds the log records, coordinates with many digits.
+static bool writeDrawing(const std::string& theFileName, int theNbEntities)
+{
+    DL_Dxf aDxf;
+    std::unique_ptr<DL_WriterA> aWriter(aDxf.out(theFileName.c_str(), DL_VERSION_2000));
+    if (aWriter.get() == NULL)
+    {
+        return false;
+    }
+
+    DL_WriterA& dw = *aWriter;
+    dw.sectionEntities();
+
+    srand(1);
+    for (int i = 0; i < theNbEntities; i++)
+    {
+        const std::string aLayer = i % 3 == 0 ? "0" : (i % 3 == 1 ? "Walls" : "Doors");
+        const DL_Attributes anAttributes(aLayer, 256, -1, "BYLAYER", 1.0);
+        const double x = rand() / 7.0 - 1000.0;
+        const double y = rand() / 13.0 + 0.1;
+
+        switch (i % 5)
+        {
+        case 0:
+            aDxf.writePoint(dw, DL_PointData(x, y, 0.0), anAttributes);
+            break;
+        case 1:
+            aDxf.writeLine(dw, DL_LineData(x, y, 0.0, y, x, 1.5), anAttributes);
+            break;
+        case 2:
+            aDxf.writeArc(dw, DL_ArcData(x, y, 0.0, 1.0 / 3.0, 10.25, 350.125), anAttributes);
+            break;
+        case 3:
+            aDxf.writeCircle(dw, DL_CircleData(x, y, 0.0, 2.0 / 7.0), anAttributes);
+            break;
+        default:
+            aDxf.writePolyline(dw, DL_PolylineData(3, 0, 0, 1), anAttributes);
+            aDxf.writeVertex(dw, DL_VertexData(x, y, 0.0, 0.0));
+            aDxf.writeVertex(dw, DL_VertexData(x + 1.0 / 9.0, y, 0.0, 0.5));
+            aDxf.writeVertex(dw, DL_VertexData(x, y + 1.0 / 11.0, 0.0, 0.0));
+            aDxf.writePolylineEnd(dw);
+            break;
+        }
+    }
+
+    dw.sectionEnd();
+    dw.dxfEOF();
+    dw.close();
+    return true;
+}
+
+//! read the file with one of the input paths of DL_Dxf.
+static std::string readDrawing(const std::string& theFileName, int thePath)
+{
+    DL_Dxf aDxf;
+    dxfLog aLog;
+    bool isDone = false;
+    if (thePath == 0)
+    {
+        isDone = aDxf.in(theFileName, &aLog);
+    }
+    else if (thePath == 1)
+    {
+        std::ifstream aStream(theFileName.c_str(), std::ios::binary);
+        isDone = aDxf.in(aStream, &aLog);
+    }
+    else
+    {
+        isDone = aDxf.inMapped(theFileName, &aLog);
+    }
+    return isDone ? aLog.text() : std::string();
+}
+
+int main(int argc, char *argv[])
+{
+    // a file of the caller, or a generated one.
+    std::string aFileName = argc > 1 ? argv[1] : "dxf-reentrant.dxf";
+    if (argc <= 1 && !writeDrawing(aFileName, 20000))
+    {
+        fprintf(stderr, "can not write %s\n", aFileName.c_str());
+        return 2;
+    }
+
+    int aNbThreads = argc > 2 ? atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+    if (aNbThreads < 4)
+    {
+        aNbThreads = 4;
+    }
+
+    const std::string aReference = readDrawing(aFileName, 0);
+    if (aReference.empty())
+    {
+        fprintf(stderr, "can not read %s\n", aFileName.c_str());
+        return 2;
+    }
+
+    // every thread reads the whole file, the input paths take turns.
+    int aNbFailed = 0;
+    const int aNbRounds = 5;
+    for (int aRound = 0; aRound < aNbRounds; aRound++)
+    {
+        std::vector<std::string> aResults(aNbThreads);
+        std::vector<std::thread> aThreads;
+        for (int i = 0; i < aNbThreads; i++)
+        {
+            aThreads.push_back(std::thread([&aResults, &aFileName, i, aRound]()
+            {
+                aResults[i] = readDrawing(aFileName, (i + aRound) % 3);
+            }));
+        }
+        for (int i = 0; i < aNbThreads; i++)
+        {
+            aThreads[i].join();
+        }
+
+        for (int i = 0; i < aNbThreads; i++)
+        {
+            if (aResults[i] != aReference)
+            {
+                printf("round %d thread %d: differs from the sequential read\n", aRound, i);
+                ++aNbFailed;
+            }
+        }
+    }
+
+    const long aNbCallbacks = (long)std::count(aReference.begin(), aReference.end(), '\n');
+    printf("%d reads of %ld callbacks on %d threads, %d differ\n", aNbRounds * aNbThreads, aNbCallbacks, aNbThreads, aNbFailed);
+    return aNbFailed > 0 ? 1 : 0;
+}